@@ -0,0 +1,153 @@
+# Generates RequestParameters.generated.h from the @param comments of the
+# request handlers (see src/RequestSchema.h for what it contains). Run as a
+# script by the build:
+#
+#   cmake -DSOURCE_DIR=<repository> -DOUTPUT=<header> -P GenerateRequestParameters.cmake
+#
+# Only top-level parameters are part of the schemas: nested ones (`a.b`,
+# `a.*.b`) are read by the handlers from the object or array that holds them.
+
+if(NOT SOURCE_DIR OR NOT OUTPUT)
+	message(FATAL_ERROR "SOURCE_DIR and OUTPUT must be set")
+endif()
+
+set(MAX_REQUEST_PARAMETERS 64)
+
+# "scene-name" -> "sceneName", "drop_shadow" -> "dropShadow"
+function(member_name parameterName outVar)
+	string(REGEX REPLACE "[-_]" ";" words "${parameterName}")
+	set(result)
+	foreach(word ${words})
+		if(result)
+			string(SUBSTRING "${word}" 0 1 first)
+			string(SUBSTRING "${word}" 1 -1 rest)
+			string(TOUPPER "${first}" first)
+			set(word "${first}${rest}")
+		endif()
+		set(result "${result}${word}")
+	endforeach()
+	set(${outVar} "${result}" PARENT_SCOPE)
+endfunction()
+
+file(GLOB handlerSources "${SOURCE_DIR}/src/WSRequestHandler_*.cpp")
+list(SORT handlerSources)
+
+set(generated "")
+set(seenRequestTypes)
+
+foreach(handlerSource ${handlerSources})
+	file(READ "${handlerSource}" content)
+	# Semicolons and brackets would break the list of comment blocks below
+	string(REPLACE ";" " " content "${content}")
+	string(REPLACE "[" "(" content "${content}")
+	string(REPLACE "]" ")" content "${content}")
+
+	string(REGEX MATCHALL "/\\*\\*([^*]|\\*+[^*/])*\\*+/" comments "${content}")
+	foreach(comment ${comments})
+		if(NOT comment MATCHES "@api[ \t]+requests")
+			continue()
+		endif()
+		if(NOT comment MATCHES "@name[ \t]+([A-Za-z0-9_]+)")
+			continue()
+		endif()
+		set(requestType "${CMAKE_MATCH_1}")
+
+		list(FIND seenRequestTypes "${requestType}" seen)
+		if(NOT seen EQUAL -1)
+			message(WARNING "${handlerSource}: ${requestType} is documented twice, ignoring the second one")
+			continue()
+		endif()
+		list(APPEND seenRequestTypes "${requestType}")
+
+		set(structName "${requestType}Parameters")
+		set(members "")
+		set(entries "")
+		set(count 0)
+
+		string(REGEX MATCHALL "@param[ \t]+{[^}]*}[ \t]+`[^`]*`" params "${comment}")
+		foreach(param ${params})
+			string(REGEX MATCH "{([^}]*)}[ \t]+`([^`]*)`" unused "${param}")
+			set(paramType "${CMAKE_MATCH_1}")
+			set(paramName "${CMAKE_MATCH_2}")
+
+			if(NOT paramName MATCHES "^[A-Za-z][A-Za-z0-9_-]*$")
+				continue()
+			endif()
+
+			set(optional false)
+			if(paramType MATCHES "\\(optional\\)")
+				set(optional true)
+				string(REGEX REPLACE "[ \t]*\\(optional\\)" "" paramType "${paramType}")
+			endif()
+			string(STRIP "${paramType}" paramType)
+			string(TOLOWER "${paramType}" paramType)
+
+			set(numberType "OBS_DATA_NUM_INVALID")
+			if(paramType STREQUAL "string")
+				set(dataType "OBS_DATA_STRING")
+				set(cppType "const char*")
+			elseif(paramType STREQUAL "int" OR paramType STREQUAL "integer")
+				set(dataType "OBS_DATA_NUMBER")
+				set(numberType "OBS_DATA_NUM_INT")
+				set(cppType "long long")
+			elseif(paramType STREQUAL "double" OR paramType STREQUAL "float")
+				set(dataType "OBS_DATA_NUMBER")
+				set(numberType "OBS_DATA_NUM_DOUBLE")
+				set(cppType "double")
+			elseif(paramType STREQUAL "boolean" OR paramType STREQUAL "bool")
+				set(dataType "OBS_DATA_BOOLEAN")
+				set(cppType "bool")
+			elseif(paramType STREQUAL "object")
+				set(dataType "OBS_DATA_OBJECT")
+				set(cppType "obs_data_t*")
+			elseif(paramType MATCHES "^array")
+				set(dataType "OBS_DATA_ARRAY")
+				set(cppType "obs_data_array_t*")
+			else()
+				message(WARNING "${handlerSource}: unknown type '${paramType}' for parameter `${paramName}` of ${requestType}, leaving it out")
+				continue()
+			endif()
+
+			member_name("${paramName}" memberName)
+			string(LENGTH "${paramName}" nameLength)
+			set(members "${members}\t${cppType} ${memberName};\n")
+			if(optional)
+				string(SUBSTRING "${memberName}" 0 1 first)
+				string(SUBSTRING "${memberName}" 1 -1 rest)
+				string(TOUPPER "${first}" first)
+				set(presentMember "has${first}${rest}")
+				set(members "${members}\tbool ${presentMember};\n")
+				set(presentOffset "offsetof(${structName}, ${presentMember})")
+			else()
+				set(presentOffset "0")
+			endif()
+			set(entries "${entries}\t\t{ \"${paramName}\", ${nameLength}, ${dataType}, ${numberType}, ${optional}, offsetof(${structName}, ${memberName}), ${presentOffset} },\n")
+			math(EXPR count "${count} + 1")
+		endforeach()
+
+		if(count EQUAL 0)
+			continue()
+		endif()
+		if(count GREATER MAX_REQUEST_PARAMETERS)
+			message(FATAL_ERROR "${handlerSource}: ${requestType} has more than ${MAX_REQUEST_PARAMETERS} parameters")
+		endif()
+
+		set(generated "${generated}struct ${structName} {\n${members}};\n\n")
+		set(generated "${generated}inline const RequestSchema& requestSchema(const ${structName}*)\n{\n")
+		set(generated "${generated}\tstatic const RequestParameter parameters[] = {\n${entries}\t};\n")
+		set(generated "${generated}\tstatic const RequestSchema schema = { \"${requestType}\", parameters, ${count} };\n")
+		set(generated "${generated}\treturn schema;\n}\n\n")
+	endforeach()
+endforeach()
+
+file(WRITE "${OUTPUT}"
+"// Generated by cmake/GenerateRequestParameters.cmake from the @param comments
+// of src/WSRequestHandler_*.cpp. Do not edit.
+
+#pragma once
+
+#include <stddef.h>
+
+#include \"RequestSchema.h\"
+
+${generated}")
@@ -19,12 +19,29 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include <obs-frontend-api.h>
 
 #include <QtCore/QCryptographicHash>
-#include <QtCore/QTime>
 #include <QtWidgets/QSystemTrayIcon>
 
 #define SECTION_NAME "WebsocketAPI"
 #define PARAM_ENABLE "ServerEnabled"
 #define PARAM_PORT "ServerPort"
+#define PARAM_IOTHREADS "ServerIoThreads"
+#define PARAM_LOCALSOCKET "LocalSocketPath"
+#define PARAM_HIGHWATERMARK "OutboundHighWaterMark"
+#define PARAM_QUEUELIMIT "OutboundQueueLimit"
+#define PARAM_SLOWCONSUMERTIMEOUT "SlowConsumerTimeout"
+#define PARAM_PINGINTERVAL "PingInterval"
+#define PARAM_PONGTIMEOUT "PongTimeout"
+#define PARAM_IDLETIMEOUT "IdleTimeout"
+#define PARAM_REPLAYBUFFERSIZE "EventReplayBufferSize"
+#define PARAM_CLIENTREADRATE "ClientReadRateLimit"
+#define PARAM_CLIENTWRITERATE "ClientWriteRateLimit"
+#define PARAM_GLOBALREADRATE "GlobalReadRateLimit"
+#define PARAM_GLOBALWRITERATE "GlobalWriteRateLimit"
+#define PARAM_COMPRESSION "CompressionEnabled"
+#define PARAM_COMPRESSIONLEVEL "CompressionLevel"
+#define PARAM_COMPRESSIONWINDOWBITS "CompressionWindowBits"
+#define PARAM_COMPRESSIONTAKEOVER "CompressionContextTakeover"
+#define PARAM_COMPRESSIONTHRESHOLD "CompressionThreshold"
 #define PARAM_DEBUG "DebugEnabled"
 #define PARAM_ALERT "AlertsEnabled"
 #define PARAM_AUTHREQUIRED "AuthRequired"
@@ -41,6 +58,24 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 Config::Config() :
 	ServerEnabled(true),
 	ServerPort(4444),
+	ServerIoThreads(1),
+	LocalSocketPath(""),
+	OutboundHighWaterMark(1024 * 1024),
+	OutboundQueueLimit(16 * 1024 * 1024),
+	SlowConsumerTimeout(5000),
+	PingInterval(10000),
+	PongTimeout(5000),
+	IdleTimeout(60000),
+	EventReplayBufferSize(1000),
+	ClientReadRateLimit(0),
+	ClientWriteRateLimit(0),
+	GlobalReadRateLimit(0),
+	GlobalWriteRateLimit(0),
+	CompressionEnabled(false),
+	CompressionLevel(6),
+	CompressionWindowBits(15),
+	CompressionContextTakeover(true),
+	CompressionThreshold(1024),
 	DebugEnabled(false),
 	AlertsEnabled(true),
 	AuthRequired(false),
@@ -48,8 +83,6 @@ Config::Config() :
 	Salt(""),
 	SettingsLoaded(false)
 {
-	qsrand(QTime::currentTime().msec());
-
 	SetDefaults();
 	SessionChallenge = GenerateSalt();
 
@@ -67,6 +100,29 @@ void Config::Load()
 
 	ServerEnabled = config_get_bool(obsConfig, SECTION_NAME, PARAM_ENABLE);
 	ServerPort = config_get_uint(obsConfig, SECTION_NAME, PARAM_PORT);
+	ServerIoThreads = config_get_uint(obsConfig, SECTION_NAME, PARAM_IOTHREADS);
+	LocalSocketPath = config_get_string(obsConfig, SECTION_NAME, PARAM_LOCALSOCKET);
+
+	OutboundHighWaterMark = config_get_uint(obsConfig, SECTION_NAME, PARAM_HIGHWATERMARK);
+	OutboundQueueLimit = config_get_uint(obsConfig, SECTION_NAME, PARAM_QUEUELIMIT);
+	SlowConsumerTimeout = config_get_uint(obsConfig, SECTION_NAME, PARAM_SLOWCONSUMERTIMEOUT);
+
+	PingInterval = config_get_uint(obsConfig, SECTION_NAME, PARAM_PINGINTERVAL);
+	PongTimeout = config_get_uint(obsConfig, SECTION_NAME, PARAM_PONGTIMEOUT);
+	IdleTimeout = config_get_uint(obsConfig, SECTION_NAME, PARAM_IDLETIMEOUT);
+
+	EventReplayBufferSize = config_get_uint(obsConfig, SECTION_NAME, PARAM_REPLAYBUFFERSIZE);
+
+	ClientReadRateLimit = config_get_uint(obsConfig, SECTION_NAME, PARAM_CLIENTREADRATE);
+	ClientWriteRateLimit = config_get_uint(obsConfig, SECTION_NAME, PARAM_CLIENTWRITERATE);
+	GlobalReadRateLimit = config_get_uint(obsConfig, SECTION_NAME, PARAM_GLOBALREADRATE);
+	GlobalWriteRateLimit = config_get_uint(obsConfig, SECTION_NAME, PARAM_GLOBALWRITERATE);
+
+	CompressionEnabled = config_get_bool(obsConfig, SECTION_NAME, PARAM_COMPRESSION);
+	CompressionLevel = config_get_uint(obsConfig, SECTION_NAME, PARAM_COMPRESSIONLEVEL);
+	CompressionWindowBits = config_get_uint(obsConfig, SECTION_NAME, PARAM_COMPRESSIONWINDOWBITS);
+	CompressionContextTakeover = config_get_bool(obsConfig, SECTION_NAME, PARAM_COMPRESSIONTAKEOVER);
+	CompressionThreshold = config_get_uint(obsConfig, SECTION_NAME, PARAM_COMPRESSIONTHRESHOLD);
 
 	DebugEnabled = config_get_bool(obsConfig, SECTION_NAME, PARAM_DEBUG);
 	AlertsEnabled = config_get_bool(obsConfig, SECTION_NAME, PARAM_ALERT);
@@ -82,6 +138,30 @@ void Config::Save()
 
 	config_set_bool(obsConfig, SECTION_NAME, PARAM_ENABLE, ServerEnabled);
 	config_set_uint(obsConfig, SECTION_NAME, PARAM_PORT, ServerPort);
+	config_set_uint(obsConfig, SECTION_NAME, PARAM_IOTHREADS, ServerIoThreads);
+	config_set_string(obsConfig, SECTION_NAME, PARAM_LOCALSOCKET,
+		QT_TO_UTF8(LocalSocketPath));
+
+	config_set_uint(obsConfig, SECTION_NAME, PARAM_HIGHWATERMARK, OutboundHighWaterMark);
+	config_set_uint(obsConfig, SECTION_NAME, PARAM_QUEUELIMIT, OutboundQueueLimit);
+	config_set_uint(obsConfig, SECTION_NAME, PARAM_SLOWCONSUMERTIMEOUT, SlowConsumerTimeout);
+
+	config_set_uint(obsConfig, SECTION_NAME, PARAM_PINGINTERVAL, PingInterval);
+	config_set_uint(obsConfig, SECTION_NAME, PARAM_PONGTIMEOUT, PongTimeout);
+	config_set_uint(obsConfig, SECTION_NAME, PARAM_IDLETIMEOUT, IdleTimeout);
+
+	config_set_uint(obsConfig, SECTION_NAME, PARAM_REPLAYBUFFERSIZE, EventReplayBufferSize);
+
+	config_set_uint(obsConfig, SECTION_NAME, PARAM_CLIENTREADRATE, ClientReadRateLimit);
+	config_set_uint(obsConfig, SECTION_NAME, PARAM_CLIENTWRITERATE, ClientWriteRateLimit);
+	config_set_uint(obsConfig, SECTION_NAME, PARAM_GLOBALREADRATE, GlobalReadRateLimit);
+	config_set_uint(obsConfig, SECTION_NAME, PARAM_GLOBALWRITERATE, GlobalWriteRateLimit);
+
+	config_set_bool(obsConfig, SECTION_NAME, PARAM_COMPRESSION, CompressionEnabled);
+	config_set_uint(obsConfig, SECTION_NAME, PARAM_COMPRESSIONLEVEL, CompressionLevel);
+	config_set_uint(obsConfig, SECTION_NAME, PARAM_COMPRESSIONWINDOWBITS, CompressionWindowBits);
+	config_set_bool(obsConfig, SECTION_NAME, PARAM_COMPRESSIONTAKEOVER, CompressionContextTakeover);
+	config_set_uint(obsConfig, SECTION_NAME, PARAM_COMPRESSIONTHRESHOLD, CompressionThreshold);
 
 	config_set_bool(obsConfig, SECTION_NAME, PARAM_DEBUG, DebugEnabled);
 	config_set_bool(obsConfig, SECTION_NAME, PARAM_ALERT, AlertsEnabled);
@@ -104,6 +184,47 @@ void Config::SetDefaults()
 			SECTION_NAME, PARAM_ENABLE, ServerEnabled);
 		config_set_default_uint(obsConfig,
 			SECTION_NAME, PARAM_PORT, ServerPort);
+		config_set_default_uint(obsConfig,
+			SECTION_NAME, PARAM_IOTHREADS, ServerIoThreads);
+		config_set_default_string(obsConfig,
+			SECTION_NAME, PARAM_LOCALSOCKET, QT_TO_UTF8(LocalSocketPath));
+
+		config_set_default_uint(obsConfig,
+			SECTION_NAME, PARAM_HIGHWATERMARK, OutboundHighWaterMark);
+		config_set_default_uint(obsConfig,
+			SECTION_NAME, PARAM_QUEUELIMIT, OutboundQueueLimit);
+		config_set_default_uint(obsConfig,
+			SECTION_NAME, PARAM_SLOWCONSUMERTIMEOUT, SlowConsumerTimeout);
+
+		config_set_default_uint(obsConfig,
+			SECTION_NAME, PARAM_PINGINTERVAL, PingInterval);
+		config_set_default_uint(obsConfig,
+			SECTION_NAME, PARAM_PONGTIMEOUT, PongTimeout);
+		config_set_default_uint(obsConfig,
+			SECTION_NAME, PARAM_IDLETIMEOUT, IdleTimeout);
+
+		config_set_default_uint(obsConfig,
+			SECTION_NAME, PARAM_REPLAYBUFFERSIZE, EventReplayBufferSize);
+
+		config_set_default_uint(obsConfig,
+			SECTION_NAME, PARAM_CLIENTREADRATE, ClientReadRateLimit);
+		config_set_default_uint(obsConfig,
+			SECTION_NAME, PARAM_CLIENTWRITERATE, ClientWriteRateLimit);
+		config_set_default_uint(obsConfig,
+			SECTION_NAME, PARAM_GLOBALREADRATE, GlobalReadRateLimit);
+		config_set_default_uint(obsConfig,
+			SECTION_NAME, PARAM_GLOBALWRITERATE, GlobalWriteRateLimit);
+
+		config_set_default_bool(obsConfig,
+			SECTION_NAME, PARAM_COMPRESSION, CompressionEnabled);
+		config_set_default_uint(obsConfig,
+			SECTION_NAME, PARAM_COMPRESSIONLEVEL, CompressionLevel);
+		config_set_default_uint(obsConfig,
+			SECTION_NAME, PARAM_COMPRESSIONWINDOWBITS, CompressionWindowBits);
+		config_set_default_bool(obsConfig,
+			SECTION_NAME, PARAM_COMPRESSIONTAKEOVER, CompressionContextTakeover);
+		config_set_default_uint(obsConfig,
+			SECTION_NAME, PARAM_COMPRESSIONTHRESHOLD, CompressionThreshold);
 
 		config_set_default_bool(obsConfig,
 			SECTION_NAME, PARAM_DEBUG, DebugEnabled);
@@ -124,16 +245,18 @@ config_t* Config::GetConfigStore()
 	return obs_frontend_get_profile_config();
 }
 
+// Empty if the system's random number generator isn't available
 QString Config::GenerateSalt()
 {
-	// Generate 32 random chars
+	// Generate 32 random bytes (256 bits) from the OS CSPRNG: salts,
+	// challenges and session tokens must not be predictable
 	const size_t randomCount = 32;
-	QByteArray randomChars;
-	for (size_t i = 0; i < randomCount; i++) {
-		randomChars.append((char)qrand());
+	QByteArray randomChars(randomCount, '\0');
+	if (!Utils::SecureRandomBytes(randomChars.data(), randomCount)) {
+		return QString();
 	}
 
-	// Convert the 32 random chars to a base64 string
+	// Convert the 32 random bytes to a base64 string
 	QString salt = randomChars.toBase64();
 
 	return salt;
@@ -184,7 +307,7 @@ bool Config::CheckAuth(QString response)
 	QString expectedResponse = hash.toBase64();
 
 	bool authSuccess = false;
-	if (response == expectedResponse) {
+	if (!SessionChallenge.isEmpty() && response == expectedResponse) {
 		SessionChallenge = GenerateSalt();
 		authSuccess = true;
 	}
@@ -205,13 +328,24 @@ void Config::OnFrontendEvent(enum obs_frontend_event event, void* param)
 
 		bool previousEnabled = config->ServerEnabled;
 		uint64_t previousPort = config->ServerPort;
+		uint64_t previousIoThreads = config->ServerIoThreads;
+		QString previousLocalSocketPath = config->LocalSocketPath;
 
 		config->SetDefaults();
 		config->Load();
 
-		if (config->ServerEnabled != previousEnabled || config->ServerPort != previousPort) {
+		if (config->ServerEnabled != previousEnabled || config->ServerPort != previousPort
+			|| config->ServerIoThreads != previousIoThreads
+			|| config->LocalSocketPath != previousLocalSocketPath)
+		{
 			auto server = GetServer();
-			server->stop();
+
+			// A new port or local socket path is applied in place by start(),
+			// keeping established connections. Only a different number of io
+			// threads requires a full restart.
+			if (!config->ServerEnabled || config->ServerIoThreads != previousIoThreads) {
+				server->stop();
+			}
 
 			if (config->ServerEnabled) {
 				server->start(config->ServerPort);
@@ -42,6 +42,29 @@ class Config {
 
 		bool ServerEnabled;
 		uint64_t ServerPort;
+		uint64_t ServerIoThreads;
+		QString LocalSocketPath;
+
+		uint64_t OutboundHighWaterMark;
+		uint64_t OutboundQueueLimit;
+		uint64_t SlowConsumerTimeout;
+
+		uint64_t PingInterval;
+		uint64_t PongTimeout;
+		uint64_t IdleTimeout;
+
+		uint64_t EventReplayBufferSize;
+
+		uint64_t ClientReadRateLimit;
+		uint64_t ClientWriteRateLimit;
+		uint64_t GlobalReadRateLimit;
+		uint64_t GlobalWriteRateLimit;
+
+		bool CompressionEnabled;
+		uint64_t CompressionLevel;
+		uint64_t CompressionWindowBits;
+		bool CompressionContextTakeover;
+		uint64_t CompressionThreshold;
 
 		bool DebugEnabled;
 		bool AlertsEnabled;
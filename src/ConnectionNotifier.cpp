@@ -0,0 +1,117 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <obs-frontend-api.h>
+#include <util/platform.h>
+#include <QtWidgets/QSystemTrayIcon>
+
+#include "obs-websocket.h"
+#include "Config.h"
+#include "Utils.h"
+
+#include "ConnectionNotifier.h"
+
+// Time (in ms) events are accumulated before being shown
+#define COALESCE_DELAY 500
+// Minimum time (in ms) between two notifications
+#define MIN_NOTIFICATION_INTERVAL 3000
+
+ConnectionNotifier::ConnectionNotifier()
+	: QObject(nullptr),
+	  _flushScheduled(false),
+	  _lastNotification(0)
+{
+	_flushTimer.setSingleShot(true);
+	connect(&_flushTimer, &QTimer::timeout, this, &ConnectionNotifier::flush);
+}
+
+void ConnectionNotifier::notifyConnection(QString clientIp)
+{
+	enqueue(clientIp, true);
+}
+
+void ConnectionNotifier::notifyDisconnection(QString clientIp)
+{
+	enqueue(clientIp, false);
+}
+
+void ConnectionNotifier::enqueue(QString clientIp, bool connected)
+{
+	if (!GetConfig()->AlertsEnabled) {
+		return;
+	}
+
+	QMutexLocker locker(&_mutex);
+	if (connected) {
+		_connected.append(clientIp);
+	} else {
+		_disconnected.append(clientIp);
+	}
+
+	if (_flushScheduled) {
+		return;
+	}
+	_flushScheduled = true;
+	locker.unlock();
+
+	QMetaObject::invokeMethod(this, "scheduleFlush", Qt::QueuedConnection);
+}
+
+void ConnectionNotifier::scheduleFlush()
+{
+	int64_t sinceLast = (int64_t)((os_gettime_ns() - _lastNotification) / 1000000);
+	int64_t delay = std::max<int64_t>(COALESCE_DELAY, MIN_NOTIFICATION_INTERVAL - sinceLast);
+	_flushTimer.start((int)delay);
+}
+
+void ConnectionNotifier::flush()
+{
+	QMutexLocker locker(&_mutex);
+	QStringList connected;
+	QStringList disconnected;
+	connected.swap(_connected);
+	disconnected.swap(_disconnected);
+	_flushScheduled = false;
+	locker.unlock();
+
+	int eventCount = connected.size() + disconnected.size();
+	if (eventCount == 0) {
+		return;
+	}
+
+	QString title;
+	QString msg;
+
+	obs_frontend_push_ui_translation(obs_module_get_string);
+	if (eventCount > 1) {
+		title = tr("OBSWebsocket.NotifySummary.Title");
+		msg = tr("OBSWebsocket.NotifySummary.Message")
+			.arg(connected.size()).arg(disconnected.size());
+	} else if (!connected.isEmpty()) {
+		title = tr("OBSWebsocket.NotifyConnect.Title");
+		msg = tr("OBSWebsocket.NotifyConnect.Message").arg(connected.first());
+	} else {
+		title = tr("OBSWebsocket.NotifyDisconnect.Title");
+		msg = tr("OBSWebsocket.NotifyDisconnect.Message").arg(disconnected.first());
+	}
+	obs_frontend_pop_ui_translation();
+
+	Utils::SysTrayNotify(msg, QSystemTrayIcon::Information, title);
+	_lastNotification = os_gettime_ns();
+}
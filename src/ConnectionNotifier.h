@@ -0,0 +1,55 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <QtCore/QObject>
+#include <QtCore/QMutex>
+#include <QtCore/QStringList>
+#include <QtCore/QTimer>
+
+// Shows tray notifications for client connections and disconnections.
+// notifyConnection() and notifyDisconnection() may be called from any thread
+// and only queue the event: the notification itself is shown later on the
+// thread owning this object (the UI thread). Events occurring close together
+// are collapsed into a single summary notification.
+class ConnectionNotifier : public QObject
+{
+Q_OBJECT
+
+public:
+	explicit ConnectionNotifier();
+	void notifyConnection(QString clientIp);
+	void notifyDisconnection(QString clientIp);
+
+private slots:
+	void scheduleFlush();
+	void flush();
+
+private:
+	void enqueue(QString clientIp, bool connected);
+
+	QMutex _mutex;
+	QStringList _connected;
+	QStringList _disconnected;
+	bool _flushScheduled;
+
+	QTimer _flushTimer;
+	uint64_t _lastNotification;
+};
@@ -19,7 +19,13 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include "ConnectionProperties.h"
 
 ConnectionProperties::ConnectionProperties()
-    : _authenticated(false)
+    : _authenticated(false),
+      _compressed(false),
+      _droppedMessages(0),
+      _overHighWaterSince(0),
+      _lastActivity(0),
+      _requestExecutor(std::make_shared<SerialExecutor>()),
+      _rejectedRequests(0)
 {
 }
 
@@ -31,4 +37,69 @@ bool ConnectionProperties::isAuthenticated()
 void ConnectionProperties::setAuthenticated(bool authenticated)
 {
     _authenticated.store(authenticated);
-}
\ No newline at end of file
+}
+
+bool ConnectionProperties::isCompressed()
+{
+    return _compressed.load();
+}
+
+void ConnectionProperties::setCompressed(bool compressed)
+{
+    _compressed.store(compressed);
+}
+
+uint64_t ConnectionProperties::droppedMessages()
+{
+    return _droppedMessages.load();
+}
+
+void ConnectionProperties::addDroppedMessage()
+{
+    _droppedMessages++;
+}
+
+uint64_t ConnectionProperties::overHighWaterSince()
+{
+    return _overHighWaterSince.load();
+}
+
+void ConnectionProperties::setOverHighWaterSince(uint64_t timestamp)
+{
+    _overHighWaterSince.store(timestamp);
+}
+
+uint64_t ConnectionProperties::lastActivity()
+{
+    return _lastActivity.load();
+}
+
+void ConnectionProperties::setLastActivity(uint64_t timestamp)
+{
+    _lastActivity.store(timestamp);
+}
+
+std::shared_ptr<SerialExecutor> ConnectionProperties::requestExecutor()
+{
+    return _requestExecutor;
+}
+
+TokenBucket& ConnectionProperties::readBucket()
+{
+    return _readBucket;
+}
+
+TokenBucket& ConnectionProperties::writeBucket()
+{
+    return _writeBucket;
+}
+
+uint64_t ConnectionProperties::rejectedRequests()
+{
+    return _rejectedRequests.load();
+}
+
+void ConnectionProperties::addRejectedRequest()
+{
+    _rejectedRequests++;
+}
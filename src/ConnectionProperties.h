@@ -19,6 +19,11 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #pragma once
 
 #include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "SerialExecutor.h"
+#include "TokenBucket.h"
 
 class ConnectionProperties
 {
@@ -26,6 +31,27 @@ public:
     explicit ConnectionProperties();
     bool isAuthenticated();
     void setAuthenticated(bool authenticated);
+    bool isCompressed();
+    void setCompressed(bool compressed);
+    uint64_t droppedMessages();
+    void addDroppedMessage();
+    uint64_t overHighWaterSince();
+    void setOverHighWaterSince(uint64_t timestamp);
+    uint64_t lastActivity();
+    void setLastActivity(uint64_t timestamp);
+    std::shared_ptr<SerialExecutor> requestExecutor();
+    TokenBucket& readBucket();
+    TokenBucket& writeBucket();
+    uint64_t rejectedRequests();
+    void addRejectedRequest();
 private:
     std::atomic<bool> _authenticated;
+    std::atomic<bool> _compressed;
+    std::atomic<uint64_t> _droppedMessages;
+    std::atomic<uint64_t> _overHighWaterSince;
+    std::atomic<uint64_t> _lastActivity;
+    std::shared_ptr<SerialExecutor> _requestExecutor;
+    TokenBucket _readBucket;
+    TokenBucket _writeBucket;
+    std::atomic<uint64_t> _rejectedRequests;
 };
\ No newline at end of file
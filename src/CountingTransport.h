@@ -0,0 +1,83 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+#include <websocketpp/transport/asio/endpoint.hpp>
+
+// websocketpp's asio transport, with connections counting the writes they
+// issue. Frames queued on a connection while a write is in progress are sent
+// together by the next one, as a single gathered async_write: the counts tell
+// how well bursts of updates are coalesced.
+template <typename config>
+class CountingConnection : public websocketpp::transport::asio::connection<config>
+{
+public:
+	typedef CountingConnection<config> type;
+	typedef websocketpp::lib::shared_ptr<type> ptr;
+	typedef websocketpp::transport::asio::connection<config> base;
+
+	explicit CountingConnection(bool isServer,
+		const websocketpp::lib::shared_ptr<typename config::alog_type>& alog,
+		const websocketpp::lib::shared_ptr<typename config::elog_type>& elog)
+		: base(isServer, alog, elog)
+	{
+	}
+
+	// Number of frame writes, and of frames they contained
+	static uint64_t writes() {
+		return _writes.load(std::memory_order_relaxed);
+	}
+	static uint64_t frames() {
+		return _frames.load(std::memory_order_relaxed);
+	}
+
+protected:
+	using base::async_write;
+
+	// Called by websocketpp for the frames waiting in the connection's send
+	// queue, with a header and a payload buffer per frame
+	void async_write(const std::vector<websocketpp::transport::buffer>& bufs,
+		websocketpp::transport::write_handler handler)
+	{
+		_writes.fetch_add(1, std::memory_order_relaxed);
+		_frames.fetch_add(bufs.size() / 2, std::memory_order_relaxed);
+		base::async_write(bufs, handler);
+	}
+
+private:
+	static std::atomic<uint64_t> _writes;
+	static std::atomic<uint64_t> _frames;
+};
+
+template <typename config>
+std::atomic<uint64_t> CountingConnection<config>::_writes(0);
+template <typename config>
+std::atomic<uint64_t> CountingConnection<config>::_frames(0);
+
+template <typename config>
+class CountingEndpoint : public websocketpp::transport::asio::endpoint<config>
+{
+public:
+	typedef CountingConnection<config> transport_con_type;
+	typedef typename transport_con_type::ptr transport_con_ptr;
+};
@@ -0,0 +1,137 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs.hpp>
+#include <util/platform.h>
+
+#include "obs-websocket.h"
+#include "Config.h"
+
+#include "EventReplayBuffer.h"
+
+// Oldest session tokens are forgotten beyond this count
+#define MAX_SESSIONS 256
+// Session tokens can't be used to resume a session after this long (in ns)
+#define SESSION_LIFETIME (60ULL * 60 * 1000000000)
+
+EventReplayBuffer::EventReplayBuffer()
+	: _lastSequence(0),
+	  _coveredFrom(1)
+{
+}
+
+uint64_t EventReplayBuffer::nextSequence()
+{
+	QMutexLocker locker(&_mutex);
+	return ++_lastSequence;
+}
+
+void EventReplayBuffer::store(uint64_t sequence, const char* json, size_t capacity)
+{
+	QMutexLocker locker(&_mutex);
+	_updates.emplace_back(sequence, json);
+
+	while (_updates.size() > capacity) {
+		_coveredFrom = _updates.front().first + 1;
+		_updates.pop_front();
+	}
+}
+
+uint64_t EventReplayBuffer::lastSequence()
+{
+	QMutexLocker locker(&_mutex);
+	return _lastSequence;
+}
+
+QString EventReplayBuffer::createSession(bool authenticated)
+{
+	auto config = GetConfig();
+	QString token = config->GenerateSalt();
+	if (token.isEmpty()) {
+		return token;
+	}
+
+	Session session;
+	session.authenticated = authenticated;
+	session.expiresAt = os_gettime_ns() + SESSION_LIFETIME;
+	session.authRequired = config->AuthRequired;
+	session.secret = config->Secret;
+
+	QMutexLocker locker(&_mutex);
+	_sessions.insert(token, session);
+	_sessionOrder.push_back(token);
+
+	while (_sessionOrder.size() > MAX_SESSIONS) {
+		_sessions.remove(_sessionOrder.front());
+		_sessionOrder.pop_front();
+	}
+
+	return token;
+}
+
+// Expired sessions, and sessions created before the password or the
+// AuthRequired setting changed, are not found
+bool EventReplayBuffer::findSession(const QString& token, bool& authenticated)
+{
+	auto config = GetConfig();
+
+	QMutexLocker locker(&_mutex);
+	auto it = _sessions.find(token);
+	if (it == _sessions.end()) {
+		return false;
+	}
+
+	const Session& session = it.value();
+	if (os_gettime_ns() > session.expiresAt
+		|| session.authRequired != config->AuthRequired
+		|| session.secret != config->Secret)
+	{
+		// Stays in _sessionOrder until it's pushed out, removing a missing
+		// token from _sessions then is harmless
+		_sessions.erase(it);
+		return false;
+	}
+
+	authenticated = session.authenticated;
+	return true;
+}
+
+// Appends the updates numbered after lastSequence to the array. Returns false
+// if some of them are no longer stored (or lastSequence is from another OBS
+// run), in which case the client has to fetch its state again.
+bool EventReplayBuffer::updatesSince(uint64_t lastSequence, obs_data_array_t* updates,
+	uint64_t& currentSequence)
+{
+	QMutexLocker locker(&_mutex);
+	currentSequence = _lastSequence;
+
+	if (lastSequence > _lastSequence || lastSequence + 1 < _coveredFrom) {
+		return false;
+	}
+
+	for (auto& update : _updates) {
+		if (update.first <= lastSequence) {
+			continue;
+		}
+
+		OBSDataAutoRelease data = obs_data_create_from_json(update.second.c_str());
+		obs_data_array_push_back(updates, data);
+	}
+
+	return true;
+}
@@ -0,0 +1,65 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <utility>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+#include <obs-data.h>
+
+// Numbers broadcast updates and keeps the most recent ones, so that a client
+// reconnecting with a session token can get the updates it missed instead of
+// rebuilding its whole state.
+class EventReplayBuffer
+{
+public:
+	explicit EventReplayBuffer();
+
+	uint64_t nextSequence();
+	void store(uint64_t sequence, const char* json, size_t capacity);
+	uint64_t lastSequence();
+
+	// Empty if no token could be generated
+	QString createSession(bool authenticated);
+	bool findSession(const QString& token, bool& authenticated);
+	bool updatesSince(uint64_t lastSequence, obs_data_array_t* updates,
+		uint64_t& currentSequence);
+
+private:
+	struct Session {
+		bool authenticated;
+		uint64_t expiresAt;
+		// Authentication settings the session was created with: changing
+		// them invalidates it
+		bool authRequired;
+		QString secret;
+	};
+
+	QMutex _mutex;
+	uint64_t _lastSequence;
+	// Lowest sequence number from which every replayable update is still stored
+	uint64_t _coveredFrom;
+	std::deque<std::pair<uint64_t, std::string>> _updates;
+	QHash<QString, Session> _sessions;
+	std::deque<QString> _sessionOrder;
+};
@@ -0,0 +1,253 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "JsonWriter.h"
+#include "Utf8.h"
+
+JsonWriter::JsonWriter(std::string& buffer)
+	: _buffer(buffer),
+	  _needsComma(false)
+{
+}
+
+void JsonWriter::beginObject()
+{
+	separator();
+	_buffer += '{';
+	_needsComma = false;
+}
+
+void JsonWriter::endObject()
+{
+	_buffer += '}';
+	_needsComma = true;
+}
+
+void JsonWriter::beginArray()
+{
+	separator();
+	_buffer += '[';
+	_needsComma = false;
+}
+
+void JsonWriter::endArray()
+{
+	_buffer += ']';
+	_needsComma = true;
+}
+
+void JsonWriter::key(const char* name)
+{
+	separator();
+	quoted(name);
+	_buffer += ':';
+	_needsComma = false;
+}
+
+void JsonWriter::string(const char* value)
+{
+	separator();
+	quoted(value ? value : "");
+	_needsComma = true;
+}
+
+void JsonWriter::integer(long long value)
+{
+	separator();
+	char number[32];
+	int length = snprintf(number, sizeof(number), "%lld", value);
+	_buffer.append(number, length);
+	_needsComma = true;
+}
+
+void JsonWriter::real(double value)
+{
+	if (isnan(value) || isinf(value)) {
+		null();
+		return;
+	}
+
+	separator();
+
+	// Same format as jansson: 17 significant digits, and always a fraction or
+	// an exponent so that the value reads back as a double
+	char number[32];
+	int length = snprintf(number, sizeof(number), "%.17g", value);
+	bool isInteger = true;
+	for (int i = 0; i < length; i++) {
+		if (number[i] == ',') {
+			// Decimal comma from the current locale
+			number[i] = '.';
+		}
+		if (number[i] == '.' || number[i] == 'e') {
+			isInteger = false;
+		}
+	}
+	_buffer.append(number, length);
+	if (isInteger) {
+		_buffer += ".0";
+	}
+	_needsComma = true;
+}
+
+void JsonWriter::boolean(bool value)
+{
+	separator();
+	_buffer += value ? "true" : "false";
+	_needsComma = true;
+}
+
+void JsonWriter::null()
+{
+	separator();
+	_buffer += "null";
+	_needsComma = true;
+}
+
+void JsonWriter::members(obs_data_t* data)
+{
+	if (!data) {
+		return;
+	}
+
+	obs_data_item_t* dataItem = obs_data_first(data);
+	for (; dataItem; obs_data_item_next(&dataItem)) {
+		if (!obs_data_item_has_user_value(dataItem)) {
+			continue;
+		}
+		key(obs_data_item_get_name(dataItem));
+		item(dataItem);
+	}
+}
+
+void JsonWriter::object(obs_data_t* data)
+{
+	beginObject();
+	if (data) {
+		members(data);
+	}
+	endObject();
+}
+
+void JsonWriter::array(obs_data_array_t* array)
+{
+	beginArray();
+	size_t count = obs_data_array_count(array);
+	for (size_t i = 0; i < count; i++) {
+		obs_data_t* element = obs_data_array_item(array, i);
+		object(element);
+		obs_data_release(element);
+	}
+	endArray();
+}
+
+void JsonWriter::separator()
+{
+	if (_needsComma) {
+		_buffer += ',';
+	}
+}
+
+void JsonWriter::item(obs_data_item_t* dataItem)
+{
+	switch (obs_data_item_gettype(dataItem)) {
+		case OBS_DATA_STRING:
+			string(obs_data_item_get_string(dataItem));
+			break;
+		case OBS_DATA_NUMBER:
+			if (obs_data_item_numtype(dataItem) == OBS_DATA_NUM_DOUBLE) {
+				real(obs_data_item_get_double(dataItem));
+			} else {
+				integer(obs_data_item_get_int(dataItem));
+			}
+			break;
+		case OBS_DATA_BOOLEAN:
+			boolean(obs_data_item_get_bool(dataItem));
+			break;
+		case OBS_DATA_OBJECT: {
+			obs_data_t* data = obs_data_item_get_obj(dataItem);
+			object(data);
+			obs_data_release(data);
+			break;
+		}
+		case OBS_DATA_ARRAY: {
+			obs_data_array_t* dataArray = obs_data_item_get_array(dataItem);
+			array(dataArray);
+			obs_data_array_release(dataArray);
+			break;
+		}
+		default:
+			null();
+			break;
+	}
+}
+
+void JsonWriter::quoted(const char* value)
+{
+	static const char hexDigits[] = "0123456789abcdef";
+
+	_buffer += '"';
+
+	// Copies runs of characters that don't need escaping in one go
+	const char* run = value;
+	for (const char* pos = value; *pos; pos++) {
+		unsigned char c = (unsigned char)*pos;
+		if (c >= 0x80) {
+			// OBS strings (source names, file paths) aren't guaranteed to be
+			// valid UTF-8, and prepared frames skip websocketpp's check:
+			// invalid bytes are replaced with U+FFFD each
+			size_t length = utf8SequenceLength(pos);
+			if (length) {
+				pos += length - 1;
+			} else {
+				_buffer.append(run, pos - run);
+				_buffer += "\xEF\xBF\xBD";
+				run = pos + 1;
+			}
+			continue;
+		}
+		if (c >= 0x20 && c != '"' && c != '\\') {
+			continue;
+		}
+
+		_buffer.append(run, pos - run);
+		run = pos + 1;
+
+		switch (c) {
+			case '"': _buffer += "\\\""; break;
+			case '\\': _buffer += "\\\\"; break;
+			case '\b': _buffer += "\\b"; break;
+			case '\f': _buffer += "\\f"; break;
+			case '\n': _buffer += "\\n"; break;
+			case '\r': _buffer += "\\r"; break;
+			case '\t': _buffer += "\\t"; break;
+			default: {
+				char escaped[] = { '\\', 'u', '0', '0', hexDigits[c >> 4], hexDigits[c & 0xF] };
+				_buffer.append(escaped, sizeof(escaped));
+				break;
+			}
+		}
+	}
+	_buffer.append(run, strlen(run));
+
+	_buffer += '"';
+}
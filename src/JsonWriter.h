@@ -0,0 +1,63 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <string>
+
+#include <obs-data.h>
+
+// Streams compact JSON into a string, which can then be moved into an outgoing
+// message as is. Commas are handled by the writer: callers only open and close
+// containers and write keys and values in order.
+//
+// obs_data is serialized like obs_data_get_json does it (members without a
+// user value are skipped), but straight from the obs_data tree, without
+// building a jansson tree first. Strings are always written as valid UTF-8:
+// their invalid bytes are replaced with U+FFFD.
+class JsonWriter
+{
+public:
+	explicit JsonWriter(std::string& buffer);
+
+	void beginObject();
+	void endObject();
+	void beginArray();
+	void endArray();
+
+	void key(const char* name);
+	void string(const char* value);
+	void integer(long long value);
+	void real(double value);
+	void boolean(bool value);
+	void null();
+
+	// Writes the members of data into the current object
+	void members(obs_data_t* data);
+	void object(obs_data_t* data);
+	void array(obs_data_array_t* array);
+
+private:
+	void separator();
+	void item(obs_data_item_t* item);
+	void quoted(const char* value);
+
+	std::string& _buffer;
+	bool _needsComma;
+};
@@ -0,0 +1,300 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <websocketpp/processors/base.hpp>
+
+#include "PerMessageDeflate.h"
+#include "obs-websocket.h"
+#include "Config.h"
+
+#define ZLIB_CHUNK_SIZE 16384
+
+using websocketpp::extensions::error::make_error_code;
+namespace extension_error = websocketpp::extensions::error;
+
+std::atomic<size_t> PerMessageDeflate::_maxMessageSize(SIZE_MAX);
+std::atomic<uint64_t> PerMessageDeflate::_compressedMessages(0);
+std::atomic<uint64_t> PerMessageDeflate::_uncompressedBytes(0);
+std::atomic<uint64_t> PerMessageDeflate::_compressedBytes(0);
+
+static bool parseWindowBits(const std::string& value, int& windowBits) {
+	if (value.empty()) {
+		return false;
+	}
+
+	char* end = nullptr;
+	long bits = strtol(value.c_str(), &end, 10);
+	if (*end != '\0' || bits < 8 || bits > 15) {
+		return false;
+	}
+
+	windowBits = (int)bits;
+	return true;
+}
+
+PerMessageDeflate::PerMessageDeflate()
+	: _enabled(false),
+	  _initialized(false),
+	  _contextTakeover(true),
+	  _level(Z_DEFAULT_COMPRESSION),
+	  _windowBits(15)
+{
+	memset(&_deflateStream, 0, sizeof(_deflateStream));
+	memset(&_inflateStream, 0, sizeof(_inflateStream));
+}
+
+PerMessageDeflate::~PerMessageDeflate()
+{
+	if (_initialized) {
+		deflateEnd(&_deflateStream);
+		inflateEnd(&_inflateStream);
+	}
+}
+
+PerMessageDeflate::err_str_pair PerMessageDeflate::negotiate(
+	websocketpp::http::attribute_list const& offer)
+{
+	err_str_pair result;
+
+	auto config = GetConfig();
+	if (!config->CompressionEnabled) {
+		result.first = make_error_code(extension_error::disabled);
+		return result;
+	}
+
+	int windowBits = std::min<int>(std::max<int>(config->CompressionWindowBits, 9), 15);
+	bool contextTakeover = config->CompressionContextTakeover;
+	bool windowBitsRequested = false;
+
+	for (auto& attribute : offer) {
+		const std::string& name = attribute.first;
+		const std::string& value = attribute.second;
+
+		if (name == "server_no_context_takeover") {
+			if (!value.empty()) {
+				result.first = make_error_code(extension_error::general);
+				return result;
+			}
+			contextTakeover = false;
+		} else if (name == "server_max_window_bits") {
+			int requestedBits;
+			// zlib can't produce raw deflate streams with an 8-bit window,
+			// so such offers are declined rather than violated
+			if (!parseWindowBits(value, requestedBits) || requestedBits < 9) {
+				result.first = make_error_code(extension_error::general);
+				return result;
+			}
+			windowBits = std::min(windowBits, requestedBits);
+			windowBitsRequested = true;
+		} else if (name == "client_no_context_takeover") {
+			if (!value.empty()) {
+				result.first = make_error_code(extension_error::general);
+				return result;
+			}
+		} else if (name == "client_max_window_bits") {
+			// Incoming messages are always inflated with a 15-bit window,
+			// which can decode anything the client may produce
+			int requestedBits;
+			if (!value.empty() && !parseWindowBits(value, requestedBits)) {
+				result.first = make_error_code(extension_error::general);
+				return result;
+			}
+		} else {
+			result.first = make_error_code(extension_error::general);
+			return result;
+		}
+	}
+
+	// The setting is read as unsigned: -1 (zlib's default level) wraps around
+	long long level = (long long)config->CompressionLevel;
+	_level = (int)std::max<long long>(Z_DEFAULT_COMPRESSION,
+		std::min<long long>(level, Z_BEST_COMPRESSION));
+	_windowBits = windowBits;
+	_contextTakeover = contextTakeover;
+
+	// websocketpp ignores the result of init(), called once the extension is
+	// accepted: the streams are set up here, so that a failure declines the
+	// extension instead of accepting it without working compression
+	if (!initStreams()) {
+		result.first = make_error_code(extension_error::general);
+		return result;
+	}
+	_enabled = true;
+
+	result.second = "permessage-deflate";
+	if (!_contextTakeover) {
+		result.second += "; server_no_context_takeover";
+	}
+	if (windowBitsRequested) {
+		result.second += "; server_max_window_bits=" + std::to_string(_windowBits);
+	}
+
+	return result;
+}
+
+websocketpp::lib::error_code PerMessageDeflate::init(bool isServer)
+{
+	if (!isServer || !_initialized) {
+		return make_error_code(extension_error::general);
+	}
+	return websocketpp::lib::error_code();
+}
+
+bool PerMessageDeflate::initStreams()
+{
+	if (_initialized) {
+		return true;
+	}
+
+	int ret = deflateInit2(&_deflateStream, _level, Z_DEFLATED,
+		-_windowBits, 8, Z_DEFAULT_STRATEGY);
+	if (ret != Z_OK) {
+		blog(LOG_WARNING, "permessage-deflate: deflateInit2 failed (%d)", ret);
+		return false;
+	}
+
+	ret = inflateInit2(&_inflateStream, -15);
+	if (ret != Z_OK) {
+		blog(LOG_WARNING, "permessage-deflate: inflateInit2 failed (%d)", ret);
+		deflateEnd(&_deflateStream);
+		return false;
+	}
+
+	_initialized = true;
+	return true;
+}
+
+std::string PerMessageDeflate::generate_offer() const
+{
+	return std::string();
+}
+
+websocketpp::lib::error_code PerMessageDeflate::validate_offer(
+	websocketpp::http::attribute_list const&)
+{
+	return make_error_code(extension_error::disabled);
+}
+
+// Output ends with the 0x00 0x00 0xff 0xff sync flush marker, which the
+// hybi13 processor strips before writing the frame.
+websocketpp::lib::error_code PerMessageDeflate::compress(
+	std::string const& in, std::string& out)
+{
+	if (!_initialized) {
+		return make_error_code(extension_error::general);
+	}
+
+	size_t outStart = out.size();
+
+	if (in.empty()) {
+		const char emptyBlock[6] = { 0x02, 0x00, 0x00, 0x00, (char)0xff, (char)0xff };
+		out.append(emptyBlock, sizeof(emptyBlock));
+	} else {
+		// Without context takeover, a full flush makes every message
+		// independent from the previous ones
+		int flush = _contextTakeover ? Z_SYNC_FLUSH : Z_FULL_FLUSH;
+
+		_deflateStream.next_in = (Bytef*)in.data();
+		_deflateStream.avail_in = (uInt)in.size();
+
+		do {
+			size_t offset = out.size();
+			out.resize(offset + ZLIB_CHUNK_SIZE);
+
+			_deflateStream.next_out = (Bytef*)&out[offset];
+			_deflateStream.avail_out = ZLIB_CHUNK_SIZE;
+
+			int ret = deflate(&_deflateStream, flush);
+			out.resize(offset + ZLIB_CHUNK_SIZE - _deflateStream.avail_out);
+
+			if (ret == Z_STREAM_ERROR) {
+				return make_error_code(extension_error::general);
+			}
+		} while (_deflateStream.avail_out == 0);
+	}
+
+	_compressedMessages++;
+	_uncompressedBytes += in.size();
+	_compressedBytes += (out.size() - outStart) - 4;
+
+	return websocketpp::lib::error_code();
+}
+
+websocketpp::lib::error_code PerMessageDeflate::decompress(
+	uint8_t const* buf, size_t len, std::string& out)
+{
+	if (!_initialized) {
+		return make_error_code(extension_error::general);
+	}
+
+	_inflateStream.next_in = (Bytef*)buf;
+	_inflateStream.avail_in = (uInt)len;
+
+	// out holds the message inflated so far, previous frames included
+	size_t maxMessageSize = _maxMessageSize.load();
+
+	int ret;
+	do {
+		size_t offset = out.size();
+		out.resize(offset + ZLIB_CHUNK_SIZE);
+
+		_inflateStream.next_out = (Bytef*)&out[offset];
+		_inflateStream.avail_out = ZLIB_CHUNK_SIZE;
+
+		ret = inflate(&_inflateStream, Z_SYNC_FLUSH);
+		out.resize(offset + ZLIB_CHUNK_SIZE - _inflateStream.avail_out);
+
+		if (out.size() > maxMessageSize) {
+			return make_error_code(websocketpp::processor::error::message_too_big);
+		}
+
+		if (ret == Z_STREAM_END) {
+			inflateReset(&_inflateStream);
+		} else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+			return make_error_code(extension_error::general);
+		}
+	} while (_inflateStream.avail_out == 0
+		|| (ret == Z_STREAM_END && _inflateStream.avail_in > 0));
+
+	return websocketpp::lib::error_code();
+}
+
+void PerMessageDeflate::setMaxMessageSize(size_t size)
+{
+	_maxMessageSize = size;
+}
+
+uint64_t PerMessageDeflate::compressedMessages()
+{
+	return _compressedMessages.load();
+}
+
+uint64_t PerMessageDeflate::uncompressedBytes()
+{
+	return _uncompressedBytes.load();
+}
+
+uint64_t PerMessageDeflate::compressedBytes()
+{
+	return _compressedBytes.load();
+}
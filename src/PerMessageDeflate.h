@@ -0,0 +1,87 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <utility>
+#include <zlib.h>
+
+#include <websocketpp/common/system_error.hpp>
+#include <websocketpp/extensions/extension.hpp>
+#include <websocketpp/http/constants.hpp>
+
+// permessage-deflate (RFC 7692) extension, plugged into websocketpp's hybi13
+// processor through the server config. Unlike websocketpp's own implementation,
+// compression level, window size and context takeover come from the plugin
+// settings, negotiation can be turned off at runtime and compression ratios
+// are accounted for.
+class PerMessageDeflate
+{
+public:
+	typedef std::pair<websocketpp::lib::error_code, std::string> err_str_pair;
+
+	explicit PerMessageDeflate();
+	~PerMessageDeflate();
+
+	bool is_implemented() const {
+		return true;
+	}
+	bool is_enabled() const {
+		return _enabled;
+	}
+
+	err_str_pair negotiate(websocketpp::http::attribute_list const& offer);
+	websocketpp::lib::error_code init(bool isServer);
+
+	// Client-side negotiation, unused by the server
+	std::string generate_offer() const;
+	websocketpp::lib::error_code validate_offer(websocketpp::http::attribute_list const& response);
+
+	websocketpp::lib::error_code compress(std::string const& in, std::string& out);
+	websocketpp::lib::error_code decompress(uint8_t const* buf, size_t len, std::string& out);
+
+	// Inflated messages larger than this fail the connection with a "message
+	// too big" error, as uncompressed ones do. Set from the endpoint's
+	// max_message_size, which only bounds the compressed payload.
+	static void setMaxMessageSize(size_t size);
+
+	static uint64_t compressedMessages();
+	static uint64_t uncompressedBytes();
+	static uint64_t compressedBytes();
+
+private:
+	PerMessageDeflate(const PerMessageDeflate&) = delete;
+	PerMessageDeflate& operator=(const PerMessageDeflate&) = delete;
+
+	bool initStreams();
+
+	bool _enabled;
+	bool _initialized;
+	bool _contextTakeover;
+	int _level;
+	int _windowBits;
+	z_stream _deflateStream;
+	z_stream _inflateStream;
+
+	static std::atomic<size_t> _maxMessageSize;
+	static std::atomic<uint64_t> _compressedMessages;
+	static std::atomic<uint64_t> _uncompressedBytes;
+	static std::atomic<uint64_t> _compressedBytes;
+};
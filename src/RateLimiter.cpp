@@ -0,0 +1,251 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <obs.hpp>
+
+#include "obs-websocket.h"
+#include "Config.h"
+#include "ConnectionProperties.h"
+#include "JsonWriter.h"
+#include "RequestView.h"
+
+#include "RateLimiter.h"
+
+TokenBucket RateLimiter::_globalReadBucket;
+TokenBucket RateLimiter::_globalWriteBucket;
+std::atomic<uint64_t> RateLimiter::_rejectedReadRequests(0);
+std::atomic<uint64_t> RateLimiter::_rejectedWriteRequests(0);
+
+bool RateLimiter::admitRequest(ConnectionProperties& connProperties,
+	const std::string& payload, std::string& rejectionResponse)
+{
+	// Only the two fields needed for admission are looked up here: full
+	// parsing is left to WSRequestHandler, on the thread pool.
+	// Payloads without a readable request type are budgeted as writes.
+	std::string requestType;
+	std::string messageId;
+	peekRequestFields(payload, requestType, messageId);
+
+	bool readRequest = isReadRequest(requestType);
+	if (connProperties.requestExecutor()->pendingTasks() >= MAX_QUEUED_REQUESTS) {
+		countRejection(connProperties, readRequest);
+	} else if (consume(connProperties, readRequest)) {
+		return true;
+	}
+
+	JsonWriter writer(rejectionResponse);
+	writer.beginObject();
+	writer.key("message-id");
+	writer.string(messageId.c_str());
+	writer.key("status");
+	writer.string("error");
+	writer.key("error");
+	writer.string(RATE_LIMIT_ERROR);
+	writer.endObject();
+
+	if (GetConfig()->DebugEnabled) {
+		blog(LOG_INFO, "request '%s' (message-id '%s') rejected: %s",
+			requestType.c_str(), messageId.c_str(), RATE_LIMIT_ERROR);
+	}
+
+	return false;
+}
+
+bool RateLimiter::admitBatchedRequest(ConnectionProperties& connProperties,
+	const std::string& requestType)
+{
+	return consume(connProperties, isReadRequest(requestType));
+}
+
+bool RateLimiter::consume(ConnectionProperties& connProperties, bool readRequest)
+{
+	auto config = GetConfig();
+
+	// Neither bucket is charged unless both have a token left, so that a
+	// client rejected by the global limit keeps its own budget
+	bool admitted;
+	if (readRequest) {
+		admitted = TokenBucket::tryConsume(
+			connProperties.readBucket(), config->ClientReadRateLimit,
+			_globalReadBucket, config->GlobalReadRateLimit);
+	} else {
+		admitted = TokenBucket::tryConsume(
+			connProperties.writeBucket(), config->ClientWriteRateLimit,
+			_globalWriteBucket, config->GlobalWriteRateLimit);
+	}
+
+	if (!admitted) {
+		countRejection(connProperties, readRequest);
+	}
+
+	return admitted;
+}
+
+void RateLimiter::countRejection(ConnectionProperties& connProperties, bool readRequest)
+{
+	connProperties.addRejectedRequest();
+	if (readRequest) {
+		_rejectedReadRequests++;
+	} else {
+		_rejectedWriteRequests++;
+	}
+}
+
+bool RateLimiter::isReadRequest(const std::string& requestType)
+{
+	return (requestType.compare(0, 3, "Get") == 0)
+		|| (requestType.compare(0, 4, "List") == 0);
+}
+
+uint64_t RateLimiter::rejectedRequests()
+{
+	return _rejectedReadRequests.load() + _rejectedWriteRequests.load();
+}
+
+uint64_t RateLimiter::rejectedReadRequests()
+{
+	return _rejectedReadRequests.load();
+}
+
+uint64_t RateLimiter::rejectedWriteRequests()
+{
+	return _rejectedWriteRequests.load();
+}
+
+// True if every backslash of a raw string value starts a valid JSON escape
+static bool hasValidEscapes(const std::string& value)
+{
+	for (size_t i = 0; i < value.size(); i++) {
+		if (value[i] != '\\') {
+			continue;
+		}
+		if (++i >= value.size()) {
+			return false;
+		}
+		if (value[i] == 'u') {
+			if (value.size() - i < 5) {
+				return false;
+			}
+			for (size_t j = i + 1; j <= i + 4; j++) {
+				if (!isxdigit((unsigned char)value[j])) {
+					return false;
+				}
+			}
+			i += 4;
+		} else if (value[i] == '\0' || !strchr("\"\\/bfnrt", value[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Single pass over the payload, without validating it, reading the string
+// values of the request-type and message-id members of the root object.
+// Members of nested objects are skipped, and the last occurrence of a member
+// wins, as in RequestView and obs_data. Names are compared raw, escapes
+// included, like RequestView does.
+void RateLimiter::peekRequestFields(const std::string& payload,
+	std::string& requestType, std::string& messageId)
+{
+	size_t pos = 0;
+	int depth = 0;
+
+	auto skipWhitespace = [&]() {
+		while (pos < payload.size() && isspace((unsigned char)payload[pos])) {
+			pos++;
+		}
+	};
+
+	// pos is on the opening quote. Moves past the closing quote and returns
+	// the raw bytes in between.
+	auto skipString = [&](size_t& start, size_t& length) {
+		start = ++pos;
+		while (pos < payload.size() && payload[pos] != '"') {
+			if (payload[pos] == '\\') {
+				pos++;
+			}
+			pos++;
+		}
+		length = std::min(pos, payload.size()) - start;
+		pos++;
+	};
+
+	while (pos < payload.size()) {
+		char c = payload[pos];
+		if (c == '{' || c == '[') {
+			depth++;
+			pos++;
+			continue;
+		}
+		if (c == '}' || c == ']') {
+			depth--;
+			pos++;
+			continue;
+		}
+		if (c != '"') {
+			pos++;
+			continue;
+		}
+
+		size_t nameStart, nameLength;
+		skipString(nameStart, nameLength);
+		if (depth != 1) {
+			continue;
+		}
+
+		// Only a string followed by a colon is a member name
+		skipWhitespace();
+		if (pos >= payload.size() || payload[pos] != ':') {
+			continue;
+		}
+		pos++;
+		skipWhitespace();
+
+		std::string* value = nullptr;
+		if (payload.compare(nameStart, nameLength, "request-type") == 0) {
+			value = &requestType;
+		} else if (payload.compare(nameStart, nameLength, "message-id") == 0) {
+			value = &messageId;
+		}
+
+		if (pos >= payload.size() || payload[pos] != '"') {
+			// Objects and arrays are skipped by the depth tracking
+			if (value) {
+				value->clear();
+			}
+			continue;
+		}
+
+		size_t valueStart, valueLength;
+		skipString(valueStart, valueLength);
+		if (!value) {
+			continue;
+		}
+
+		// Decoded as the request handler will, so that a rejection echoes
+		// the message-id the client sent. Invalid escapes (the payload
+		// will be refused anyway) are kept as is.
+		value->assign(payload, valueStart, valueLength);
+		if (value->find('\\') != std::string::npos && hasValidEscapes(*value)) {
+			value->resize(RequestView::unescape(&(*value)[0], value->size()));
+		}
+	}
+}
@@ -0,0 +1,63 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <atomic>
+#include <string>
+
+#include "TokenBucket.h"
+
+#define RATE_LIMIT_ERROR "rate limit exceeded"
+// Requests a client can have waiting for its previous ones to complete. Past
+// this, its requests are rejected whatever its rate budget.
+#define MAX_QUEUED_REQUESTS 256
+// Rejections are queued too, behind the client's requests: a client still
+// sending once this many tasks are waiting is disconnected
+#define MAX_QUEUED_TASKS (2 * MAX_QUEUED_REQUESTS)
+
+class ConnectionProperties;
+
+// Admission control run on the transport thread before a request is queued
+// for processing. Requests are split into two classes with separate budgets:
+// reads (Get*/List* request types) and everything else, which may change state.
+class RateLimiter
+{
+public:
+	static bool admitRequest(ConnectionProperties& connProperties,
+		const std::string& payload, std::string& rejectionResponse);
+	// Charges one request of an ExecuteBatch, on the thread pool
+	static bool admitBatchedRequest(ConnectionProperties& connProperties,
+		const std::string& requestType);
+
+	static bool isReadRequest(const std::string& requestType);
+	static uint64_t rejectedRequests();
+	static uint64_t rejectedReadRequests();
+	static uint64_t rejectedWriteRequests();
+
+private:
+	static bool consume(ConnectionProperties& connProperties, bool readRequest);
+	static void countRejection(ConnectionProperties& connProperties, bool readRequest);
+	static void peekRequestFields(const std::string& payload,
+		std::string& requestType, std::string& messageId);
+
+	static TokenBucket _globalReadBucket;
+	static TokenBucket _globalWriteBucket;
+	static std::atomic<uint64_t> _rejectedReadRequests;
+	static std::atomic<uint64_t> _rejectedWriteRequests;
+};
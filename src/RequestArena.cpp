@@ -0,0 +1,160 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <QtCore/QThreadStorage>
+
+#include "RequestArena.h"
+
+#define FIRST_BLOCK_SIZE (16 * 1024)
+// Beyond this, blocks and response buffer capacity left by an unusually large
+// request are given back to the heap when it ends
+#define MAX_RETAINED_BYTES (1024 * 1024)
+#define ALIGNMENT 16
+
+std::atomic<uint64_t> RequestArena::_requests(0);
+std::atomic<uint64_t> RequestArena::_allocations(0);
+std::atomic<uint64_t> RequestArena::_allocatedBytes(0);
+std::atomic<uint64_t> RequestArena::_peakBytes(0);
+std::atomic<uint64_t> RequestArena::_blockAllocations(0);
+
+static QThreadStorage<RequestArena*> threadArenas;
+
+RequestArena::Scope::Scope()
+	: _arena(RequestArena::current())
+{
+	_arena._depth++;
+}
+
+RequestArena::Scope::~Scope()
+{
+	if (--_arena._depth == 0) {
+		_arena.reset();
+	}
+}
+
+RequestArena& RequestArena::current()
+{
+	if (!threadArenas.hasLocalData()) {
+		threadArenas.setLocalData(new RequestArena());
+	}
+	return *threadArenas.localData();
+}
+
+RequestArena::RequestArena()
+	: _currentBlock(0),
+	  _offset(0),
+	  _depth(0),
+	  _requestAllocations(0),
+	  _requestBytes(0)
+{
+	addBlock(FIRST_BLOCK_SIZE);
+}
+
+RequestArena::~RequestArena()
+{
+	for (Block& block : _blocks) {
+		delete[] block.data;
+	}
+}
+
+void* RequestArena::allocate(size_t size)
+{
+	size = (size + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1);
+	_requestAllocations++;
+	_requestBytes += size;
+
+	while (_offset + size > _blocks[_currentBlock].size) {
+		_currentBlock++;
+		_offset = 0;
+		if (_currentBlock == _blocks.size()) {
+			addBlock(size);
+		}
+	}
+
+	void* ptr = _blocks[_currentBlock].data + _offset;
+	_offset += size;
+	return ptr;
+}
+
+void RequestArena::addBlock(size_t minSize)
+{
+	size_t size = _blocks.empty() ? FIRST_BLOCK_SIZE : _blocks.back().size * 2;
+	while (size < minSize) {
+		size *= 2;
+	}
+
+	// new[] memory is aligned for any fundamental type, which covers ALIGNMENT
+	Block block;
+	block.data = new char[size];
+	block.size = size;
+	_blocks.push_back(block);
+	_blockAllocations++;
+}
+
+uint64_t RequestArena::requests()
+{
+	return _requests.load();
+}
+
+uint64_t RequestArena::allocations()
+{
+	return _allocations.load();
+}
+
+uint64_t RequestArena::allocatedBytes()
+{
+	return _allocatedBytes.load();
+}
+
+uint64_t RequestArena::peakBytes()
+{
+	return _peakBytes.load();
+}
+
+uint64_t RequestArena::blockAllocations()
+{
+	return _blockAllocations.load();
+}
+
+void RequestArena::reset()
+{
+	_requests++;
+	_allocations += _requestAllocations;
+	_allocatedBytes += _requestBytes;
+
+	uint64_t peak = _peakBytes.load();
+	while (_requestBytes > peak && !_peakBytes.compare_exchange_weak(peak, _requestBytes)) {
+	}
+
+	_currentBlock = 0;
+	_offset = 0;
+	_requestAllocations = 0;
+	_requestBytes = 0;
+	_responseBuffer.clear();
+
+	// Only after a large request: regular resets stay O(1)
+	if (_blocks.size() > 1 && _blocks.back().size > MAX_RETAINED_BYTES) {
+		for (size_t i = 1; i < _blocks.size(); i++) {
+			delete[] _blocks[i].data;
+		}
+		_blocks.resize(1);
+	}
+	if (_responseBuffer.capacity() > MAX_RETAINED_BYTES) {
+		std::string().swap(_responseBuffer);
+	}
+}
@@ -0,0 +1,87 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <atomic>
+#include <string>
+#include <vector>
+
+// Per-thread bump allocator for memory that only lives as long as a request:
+// the index of the request payload and the response while it's being written.
+// A Scope covers one request; when the outermost Scope of a thread ends, all of
+// it is released at once by rewinding to the start of the first block. Blocks
+// are kept for the next request (up to 1 MB), so a thread that keeps serving
+// similar requests stops allocating from the heap.
+class RequestArena
+{
+public:
+	class Scope
+	{
+	public:
+		Scope();
+		~Scope();
+
+	private:
+		RequestArena& _arena;
+	};
+
+	static RequestArena& current();
+
+	// Aligned for any type. Never fails; there is nothing to free.
+	void* allocate(size_t size);
+
+	// Scratch buffer for the response of the current request. Cleared between
+	// requests but keeps its capacity.
+	std::string& responseBuffer() {
+		return _responseBuffer;
+	}
+
+	static uint64_t requests();
+	static uint64_t allocations();
+	static uint64_t allocatedBytes();
+	static uint64_t peakBytes();
+	static uint64_t blockAllocations();
+
+	~RequestArena();
+
+private:
+	struct Block {
+		char* data;
+		size_t size;
+	};
+
+	RequestArena();
+	void addBlock(size_t minSize);
+	void reset();
+
+	std::vector<Block> _blocks;
+	size_t _currentBlock;
+	size_t _offset;
+	int _depth;
+	uint64_t _requestAllocations;
+	uint64_t _requestBytes;
+	std::string _responseBuffer;
+
+	static std::atomic<uint64_t> _requests;
+	static std::atomic<uint64_t> _allocations;
+	static std::atomic<uint64_t> _allocatedBytes;
+	static std::atomic<uint64_t> _peakBytes;
+	static std::atomic<uint64_t> _blockAllocations;
+};
@@ -0,0 +1,56 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+#include <obs-data.h>
+
+// Top-level parameters of a request type, as documented by the @param comments
+// of its handler. RequestParameters.generated.h is written at build time by
+// cmake/GenerateRequestParameters.cmake: for each request type, a
+// <RequestType>Parameters struct with one member per parameter (and a has*
+// flag for the optional ones) and its schema, which
+// WSRequestHandler::readParameters() uses to fill the struct.
+//
+// Members are typed after the documented type: const char* for strings, long
+// long for ints, double for doubles and floats, bool, and obs_data_t* /
+// obs_data_array_t* for objects and arrays. Strings, objects and arrays belong
+// to the request and are only valid while it's being handled.
+struct RequestParameter {
+	const char* name;
+	size_t nameLength;
+	obs_data_type type;
+	// For numbers, type of the member: OBS_DATA_NUM_INT or OBS_DATA_NUM_DOUBLE
+	obs_data_number_type numberType;
+	bool optional;
+	size_t offset;
+	// Offset of the has* flag of optional parameters
+	size_t presentOffset;
+};
+
+struct RequestSchema {
+	const char* requestType;
+	const RequestParameter* parameters;
+	size_t count;
+};
+
+// The generator refuses request types with more parameters than this, so that
+// readParameters() can track them in a single bit mask
+#define MAX_REQUEST_PARAMETERS 64
@@ -0,0 +1,179 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "RequestStats.h"
+
+#define SUB_BUCKETS (1 << LATENCY_SUB_BUCKET_BITS)
+
+static const char* stageNames[RequestStats::StageCount] = {
+	"queue-wait",
+	"parse",
+	"handler",
+	"serialize"
+};
+
+static inline int highestBit(uint64_t value)
+{
+#if defined(__GNUC__)
+	return 63 - __builtin_clzll(value);
+#else
+	int bit = 0;
+	while (value >>= 1) {
+		bit++;
+	}
+	return bit;
+#endif
+}
+
+void LatencyHistogram::record(uint64_t nanoseconds)
+{
+	_buckets[bucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+	_sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+	uint64_t max = _max.load(std::memory_order_relaxed);
+	while (nanoseconds > max
+		&& !_max.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed)) {
+	}
+}
+
+void LatencyHistogram::reset()
+{
+	for (size_t i = 0; i < LATENCY_BUCKET_COUNT; i++) {
+		_buckets[i].store(0, std::memory_order_relaxed);
+	}
+	_sum.store(0, std::memory_order_relaxed);
+	_max.store(0, std::memory_order_relaxed);
+}
+
+obs_data_t* LatencyHistogram::summary() const
+{
+	uint64_t counts[LATENCY_BUCKET_COUNT];
+	uint64_t count = 0;
+	for (size_t i = 0; i < LATENCY_BUCKET_COUNT; i++) {
+		counts[i] = _buckets[i].load(std::memory_order_relaxed);
+		count += counts[i];
+	}
+	uint64_t max = _max.load(std::memory_order_relaxed);
+
+	obs_data_t* summary = obs_data_create();
+	obs_data_set_int(summary, "count", count);
+	obs_data_set_double(summary, "mean",
+		count ? _sum.load(std::memory_order_relaxed) / 1000.0 / count : 0.0);
+
+	static const struct {
+		const char* name;
+		double quantile;
+	} percentiles[] = {
+		{ "p50", 0.5 },
+		{ "p90", 0.9 },
+		{ "p99", 0.99 },
+		{ "p999", 0.999 }
+	};
+
+	// Each percentile is reported as the upper bound of its bucket
+	size_t bucket = 0;
+	uint64_t seen = 0;
+	for (auto& percentile : percentiles) {
+		uint64_t rank = (uint64_t)(percentile.quantile * count + 0.5);
+		if (rank == 0) {
+			rank = 1;
+		}
+
+		uint64_t value = 0;
+		if (count) {
+			while (bucket < LATENCY_BUCKET_COUNT && seen + counts[bucket] < rank) {
+				seen += counts[bucket];
+				bucket++;
+			}
+			// The last bucket has no upper bound
+			value = (bucket < LATENCY_BUCKET_COUNT - 1) ? bucketUpperBound(bucket) : max;
+			if (value > max) {
+				value = max;
+			}
+		}
+		obs_data_set_double(summary, percentile.name, value / 1000.0);
+	}
+
+	obs_data_set_double(summary, "max", max / 1000.0);
+	return summary;
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t value)
+{
+	if (value < 2 * SUB_BUCKETS) {
+		return (size_t)value;
+	}
+
+	int magnitude = highestBit(value);
+	if (magnitude >= LATENCY_MAX_MAGNITUDE) {
+		return LATENCY_BUCKET_COUNT - 1;
+	}
+
+	int shift = magnitude - LATENCY_SUB_BUCKET_BITS;
+	return ((size_t)(shift + 1) << LATENCY_SUB_BUCKET_BITS)
+		+ (size_t)((value >> shift) & (SUB_BUCKETS - 1));
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index)
+{
+	if (index < 2 * SUB_BUCKETS) {
+		return index;
+	}
+
+	int shift = (int)(index >> LATENCY_SUB_BUCKET_BITS) - 1;
+	uint64_t lowerBound = (uint64_t)(SUB_BUCKETS + (index & (SUB_BUCKETS - 1))) << shift;
+	return lowerBound + ((uint64_t)1 << shift) - 1;
+}
+
+void RequestStats::record(bool error, const uint64_t (&durations)[StageCount])
+{
+	_requests.fetch_add(1, std::memory_order_relaxed);
+	if (error) {
+		_errors.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	for (int stage = 0; stage < StageCount; stage++) {
+		if (durations[stage]) {
+			_stages[stage].record(durations[stage]);
+		}
+	}
+}
+
+void RequestStats::reset()
+{
+	_requests.store(0, std::memory_order_relaxed);
+	_errors.store(0, std::memory_order_relaxed);
+	for (int stage = 0; stage < StageCount; stage++) {
+		_stages[stage].reset();
+	}
+}
+
+obs_data_t* RequestStats::summary() const
+{
+	obs_data_t* summary = obs_data_create();
+	obs_data_set_int(summary, "requests", _requests.load(std::memory_order_relaxed));
+	obs_data_set_int(summary, "errors", _errors.load(std::memory_order_relaxed));
+
+	for (int stage = 0; stage < StageCount; stage++) {
+		obs_data_t* stageSummary = _stages[stage].summary();
+		obs_data_set_obj(summary, stageNames[stage], stageSummary);
+		obs_data_release(stageSummary);
+	}
+
+	return summary;
+}
@@ -0,0 +1,89 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+#include <obs-data.h>
+
+// Values below 2^(SUB_BUCKET_BITS + 1) get a bucket each; above that, every
+// power of two is split in 2^SUB_BUCKET_BITS buckets (12.5% wide). Durations
+// of 2^36 ns (about 69 seconds) and more share the last bucket.
+#define LATENCY_SUB_BUCKET_BITS 3
+#define LATENCY_MAX_MAGNITUDE 36
+#define LATENCY_BUCKET_COUNT \
+	((LATENCY_MAX_MAGNITUDE - LATENCY_SUB_BUCKET_BITS + 1) << LATENCY_SUB_BUCKET_BITS)
+
+// HDR-style log-linear histogram of durations in nanoseconds. Recording is a
+// few relaxed atomic increments and never blocks; readers get an approximate
+// snapshot while requests keep being recorded.
+//
+// Zero-initialized in static storage, so that arrays of them cost nothing
+// until they're written to.
+class LatencyHistogram
+{
+public:
+	void record(uint64_t nanoseconds);
+	void reset();
+
+	// count, and mean, p50, p90, p99, p999 and max in microseconds
+	obs_data_t* summary() const;
+
+private:
+	static size_t bucketIndex(uint64_t value);
+	static uint64_t bucketUpperBound(size_t index);
+
+	std::atomic<uint64_t> _buckets[LATENCY_BUCKET_COUNT];
+	std::atomic<uint64_t> _sum;
+	std::atomic<uint64_t> _max;
+};
+
+// Counters and per-stage latency histograms of one request type
+class RequestStats
+{
+public:
+	enum Stage {
+		// From the request being received to a worker picking it up
+		QueueWait,
+		// Payload parsing and validation, up to the handler call
+		Parse,
+		Handler,
+		// Writing the response
+		Serialize,
+		StageCount
+	};
+
+	// A duration of 0 stands for a stage that didn't run, and isn't recorded
+	void record(bool error, const uint64_t (&durations)[StageCount]);
+	void reset();
+
+	uint64_t requests() const {
+		return _requests.load(std::memory_order_relaxed);
+	}
+
+	// requests, errors, and a histogram summary per stage
+	obs_data_t* summary() const;
+
+private:
+	std::atomic<uint64_t> _requests;
+	std::atomic<uint64_t> _errors;
+	LatencyHistogram _stages[StageCount];
+};
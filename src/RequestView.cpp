@@ -0,0 +1,597 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <errno.h>
+#include <locale.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "RequestArena.h"
+#include "RequestView.h"
+#include "Utf8.h"
+
+// Same nesting limit as jansson, so both parsers accept the same payloads
+#define MAX_DEPTH 2048
+#define INITIAL_CAPACITY 16
+
+#define ONES 0x0101010101010101ULL
+#define HIGH_BITS 0x8080808080808080ULL
+
+// True if any of the 8 bytes of word is a quote, a backslash, a control
+// character or a non-ASCII byte (to be checked for valid UTF-8). May report
+// false positives (never false negatives), which only send the caller to its
+// byte-by-byte path.
+static inline bool hasSpecialByte(uint64_t word)
+{
+	uint64_t quotes = word ^ (ONES * '"');
+	uint64_t backslashes = word ^ (ONES * '\\');
+	return (((quotes - ONES) & ~quotes)
+		| ((backslashes - ONES) & ~backslashes)
+		| ((word - ONES * 0x20) & ~word)
+		| word) & HIGH_BITS;
+}
+
+static inline int hexValue(char c)
+{
+	if (c >= '0' && c <= '9') {
+		return c - '0';
+	}
+	if (c >= 'a' && c <= 'f') {
+		return c - 'a' + 10;
+	}
+	if (c >= 'A' && c <= 'F') {
+		return c - 'A' + 10;
+	}
+	return -1;
+}
+
+static inline uint32_t readHex4(const char* pos)
+{
+	return (hexValue(pos[0]) << 12) | (hexValue(pos[1]) << 8)
+		| (hexValue(pos[2]) << 4) | hexValue(pos[3]);
+}
+
+RequestView::RequestView()
+	: _end(nullptr),
+	  _members(nullptr),
+	  _count(0),
+	  _capacity(0)
+{
+}
+
+bool RequestView::parse(std::string& payload)
+{
+	_members = nullptr;
+	_count = 0;
+	_capacity = 0;
+	if (payload.empty()) {
+		return false;
+	}
+
+	// std::string guarantees a NUL after the last byte, which fails every
+	// check below and stops the parser without explicit bounds checks.
+	char* pos = &payload[0];
+	_end = pos + payload.size();
+
+	skipWhitespace(pos);
+	if (*pos != '{') {
+		return false;
+	}
+	pos++;
+	skipWhitespace(pos);
+
+	if (*pos == '}') {
+		pos++;
+	} else {
+		for (;;) {
+			if (*pos != '"') {
+				return false;
+			}
+
+			Member member;
+			bool nameEscaped;
+			member.name = pos + 1;
+			if (!parseString(pos, nameEscaped)) {
+				return false;
+			}
+			member.nameLength = (uint32_t)(pos - 1 - member.name);
+
+			skipWhitespace(pos);
+			if (*pos != ':') {
+				return false;
+			}
+			pos++;
+			skipWhitespace(pos);
+
+			char* value = pos;
+			if (!parseValue(pos, 1, member.type, member.integer, member.escaped)) {
+				return false;
+			}
+
+			if (member.type == OBS_DATA_STRING) {
+				member.value = value + 1;
+				member.valueLength = (uint32_t)(pos - 1 - member.value);
+			} else {
+				member.value = value;
+				member.valueLength = (uint32_t)(pos - value);
+			}
+			member.terminated = false;
+
+			if (member.type != OBS_DATA_NULL) {
+				append(member);
+			}
+
+			skipWhitespace(pos);
+			if (*pos == ',') {
+				pos++;
+				skipWhitespace(pos);
+				continue;
+			}
+			if (*pos == '}') {
+				pos++;
+				break;
+			}
+			return false;
+		}
+	}
+
+	skipWhitespace(pos);
+	return pos == _end;
+}
+
+obs_data_type RequestView::type(const char* name) const
+{
+	int index = find(name);
+	return (index >= 0) ? _members[index].type : OBS_DATA_NULL;
+}
+
+obs_data_number_type RequestView::numberType(const char* name) const
+{
+	int index = find(name);
+	return (index >= 0) ? numberTypeAt(index) : OBS_DATA_NUM_INVALID;
+}
+
+bool RequestView::peekString(const char* name, const char*& value, size_t& length) const
+{
+	int index = find(name);
+	if (index < 0 || _members[index].type != OBS_DATA_STRING) {
+		return false;
+	}
+
+	value = _members[index].value;
+	length = _members[index].valueLength;
+	return true;
+}
+
+const char* RequestView::getString(const char* name)
+{
+	int index = find(name);
+	return (index >= 0) ? stringAt(index) : "";
+}
+
+bool RequestView::getBool(const char* name) const
+{
+	int index = find(name);
+	return (index >= 0) ? boolAt(index) : false;
+}
+
+long long RequestView::getInt(const char* name) const
+{
+	int index = find(name);
+	return (index >= 0) ? intAt(index) : 0;
+}
+
+double RequestView::getDouble(const char* name) const
+{
+	int index = find(name);
+	return (index >= 0) ? doubleAt(index) : 0.0;
+}
+
+const char* RequestView::nameAt(size_t index, size_t& length) const
+{
+	length = _members[index].nameLength;
+	return _members[index].name;
+}
+
+obs_data_type RequestView::typeAt(size_t index) const
+{
+	return _members[index].type;
+}
+
+obs_data_number_type RequestView::numberTypeAt(size_t index) const
+{
+	if (_members[index].type != OBS_DATA_NUMBER) {
+		return OBS_DATA_NUM_INVALID;
+	}
+	return _members[index].integer ? OBS_DATA_NUM_INT : OBS_DATA_NUM_DOUBLE;
+}
+
+const char* RequestView::stringAt(size_t index)
+{
+	Member& member = _members[index];
+	if (member.type != OBS_DATA_STRING) {
+		return "";
+	}
+
+	// The closing quote (or, once unescaped, the byte after the shorter
+	// value) is overwritten with the terminator
+	if (!member.terminated) {
+		if (member.escaped) {
+			member.valueLength = (uint32_t)unescape(member.value, member.valueLength);
+		}
+		member.value[member.valueLength] = '\0';
+		member.terminated = true;
+	}
+	return member.value;
+}
+
+bool RequestView::boolAt(size_t index) const
+{
+	return _members[index].type == OBS_DATA_BOOLEAN
+		&& _members[index].value[0] == 't';
+}
+
+long long RequestView::intAt(size_t index) const
+{
+	const Member& member = _members[index];
+	if (member.type != OBS_DATA_NUMBER) {
+		return 0;
+	}
+
+	if (!member.integer) {
+		return (long long)doubleAt(index);
+	}
+	return strtoll(member.value, nullptr, 10);
+}
+
+double RequestView::doubleAt(size_t index) const
+{
+	const Member& member = _members[index];
+	if (member.type != OBS_DATA_NUMBER) {
+		return 0.0;
+	}
+
+	if (member.integer) {
+		return (double)strtoll(member.value, nullptr, 10);
+	}
+
+	// strtod() follows LC_NUMERIC, which the UI may have changed: swap the
+	// JSON decimal point for the current one on a copy, as jansson does
+	char buffer[64];
+	char* number = (member.valueLength < sizeof(buffer))
+		? buffer
+		: (char*)RequestArena::current().allocate(member.valueLength + 1);
+	memcpy(number, member.value, member.valueLength);
+	number[member.valueLength] = '\0';
+
+	char decimalPoint = *localeconv()->decimal_point;
+	if (decimalPoint != '.') {
+		char* dot = strchr(number, '.');
+		if (dot) {
+			*dot = decimalPoint;
+		}
+	}
+	return strtod(number, nullptr);
+}
+
+int RequestView::find(const char* name) const
+{
+	// Last occurrence wins, like in obs_data
+	size_t length = strlen(name);
+	for (int i = (int)_count - 1; i >= 0; i--) {
+		const Member& member = _members[i];
+		if (member.nameLength == length && memcmp(member.name, name, length) == 0) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+void RequestView::append(const Member& member)
+{
+	if (_count == _capacity) {
+		// The previous array stays in the arena until the request ends
+		size_t capacity = _capacity ? _capacity * 2 : INITIAL_CAPACITY;
+		Member* members = (Member*)RequestArena::current().allocate(capacity * sizeof(Member));
+		if (_count) {
+			memcpy(members, _members, _count * sizeof(Member));
+		}
+		_members = members;
+		_capacity = capacity;
+	}
+	_members[_count++] = member;
+}
+
+bool RequestView::parseValue(char*& pos, int depth, obs_data_type& type,
+	bool& integer, bool& escaped)
+{
+	integer = false;
+	escaped = false;
+
+	switch (*pos) {
+		case '"':
+			type = OBS_DATA_STRING;
+			return parseString(pos, escaped);
+		case '{':
+			type = OBS_DATA_OBJECT;
+			return parseContainer(pos, depth);
+		case '[':
+			type = OBS_DATA_ARRAY;
+			return parseContainer(pos, depth);
+		case 't':
+			type = OBS_DATA_BOOLEAN;
+			return parseLiteral(pos, "true", 4);
+		case 'f':
+			type = OBS_DATA_BOOLEAN;
+			return parseLiteral(pos, "false", 5);
+		case 'n':
+			type = OBS_DATA_NULL;
+			return parseLiteral(pos, "null", 4);
+		default:
+			type = OBS_DATA_NUMBER;
+			return parseNumber(pos, integer);
+	}
+}
+
+bool RequestView::parseContainer(char*& pos, int depth)
+{
+	if (depth >= MAX_DEPTH) {
+		return false;
+	}
+
+	bool isObject = (*pos == '{');
+	char closing = isObject ? '}' : ']';
+	pos++;
+	skipWhitespace(pos);
+
+	if (*pos == closing) {
+		pos++;
+		return true;
+	}
+
+	for (;;) {
+		if (isObject) {
+			bool nameEscaped;
+			if (*pos != '"' || !parseString(pos, nameEscaped)) {
+				return false;
+			}
+			skipWhitespace(pos);
+			if (*pos != ':') {
+				return false;
+			}
+			pos++;
+			skipWhitespace(pos);
+		}
+
+		obs_data_type type;
+		bool integer, escaped;
+		if (!parseValue(pos, depth + 1, type, integer, escaped)) {
+			return false;
+		}
+
+		skipWhitespace(pos);
+		if (*pos == ',') {
+			pos++;
+			skipWhitespace(pos);
+			continue;
+		}
+		if (*pos == closing) {
+			pos++;
+			return true;
+		}
+		return false;
+	}
+}
+
+bool RequestView::parseString(char*& pos, bool& escaped)
+{
+	escaped = false;
+	pos++;
+
+	for (;;) {
+		// Skip 8 plain bytes at a time
+		while (_end - pos >= 8) {
+			uint64_t word;
+			memcpy(&word, pos, sizeof(word));
+			if (hasSpecialByte(word)) {
+				break;
+			}
+			pos += 8;
+		}
+
+		unsigned char c = (unsigned char)*pos;
+		if (c == '"') {
+			pos++;
+			return true;
+		}
+
+		if (c == '\\') {
+			escaped = true;
+			c = (unsigned char)pos[1];
+			if (c == 'u') {
+				for (int i = 2; i < 6; i++) {
+					if (hexValue(pos[i]) < 0) {
+						return false;
+					}
+				}
+				pos += 6;
+			} else if (c != '\0' && strchr("\"\\/bfnrt", c)) {
+				pos += 2;
+			} else {
+				return false;
+			}
+			continue;
+		}
+
+		if (c >= 0x80) {
+			// Rejected by jansson, and so by the obs_data fallback
+			size_t length = utf8SequenceLength(pos);
+			if (!length) {
+				return false;
+			}
+			pos += length;
+			continue;
+		}
+
+		// Also stops at the terminating NUL
+		if (c < 0x20) {
+			return false;
+		}
+		pos++;
+	}
+}
+
+bool RequestView::parseNumber(char*& pos, bool& integer)
+{
+	integer = true;
+	char* start = pos;
+
+	if (*pos == '-') {
+		pos++;
+	}
+
+	char* digits = pos;
+	if (*pos == '0') {
+		pos++;
+	} else if (*pos >= '1' && *pos <= '9') {
+		while (*pos >= '0' && *pos <= '9') {
+			pos++;
+		}
+	} else {
+		return false;
+	}
+	size_t digitCount = pos - digits;
+
+	if (*pos == '.') {
+		integer = false;
+		pos++;
+		if (*pos < '0' || *pos > '9') {
+			return false;
+		}
+		while (*pos >= '0' && *pos <= '9') {
+			pos++;
+		}
+	}
+
+	if (*pos == 'e' || *pos == 'E') {
+		integer = false;
+		pos++;
+		if (*pos == '+' || *pos == '-') {
+			pos++;
+		}
+		if (*pos < '0' || *pos > '9') {
+			return false;
+		}
+		while (*pos >= '0' && *pos <= '9') {
+			pos++;
+		}
+	}
+
+	// jansson refuses integers that don't fit in a long long, rather than
+	// saturating them as strtoll() does. Any 18-digit integer fits.
+	if (integer && digitCount > 18) {
+		errno = 0;
+		strtoll(start, nullptr, 10);
+		if (errno == ERANGE) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool RequestView::parseLiteral(char*& pos, const char* literal, size_t length)
+{
+	if (strncmp(pos, literal, length) != 0) {
+		return false;
+	}
+	pos += length;
+	return true;
+}
+
+void RequestView::skipWhitespace(char*& pos)
+{
+	while (*pos == ' ' || *pos == '\t' || *pos == '\n' || *pos == '\r') {
+		pos++;
+	}
+}
+
+size_t RequestView::unescape(char* value, size_t length)
+{
+	char* in = value;
+	char* out = value;
+	char* end = value + length;
+
+	while (in < end) {
+		if (*in != '\\') {
+			*out++ = *in++;
+			continue;
+		}
+
+		char c = in[1];
+		in += 2;
+		switch (c) {
+			case 'b': *out++ = '\b'; break;
+			case 'f': *out++ = '\f'; break;
+			case 'n': *out++ = '\n'; break;
+			case 'r': *out++ = '\r'; break;
+			case 't': *out++ = '\t'; break;
+			case 'u': {
+				uint32_t codepoint = readHex4(in);
+				in += 4;
+
+				if (codepoint >= 0xD800 && codepoint <= 0xDBFF
+					&& in + 6 <= end && in[0] == '\\' && in[1] == 'u')
+				{
+					uint32_t low = readHex4(in + 2);
+					if (low >= 0xDC00 && low <= 0xDFFF) {
+						codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+						in += 6;
+					}
+				}
+				if (codepoint >= 0xD800 && codepoint <= 0xDFFF) {
+					// Unpaired surrogate
+					codepoint = 0xFFFD;
+				}
+
+				if (codepoint < 0x80) {
+					*out++ = (char)codepoint;
+				} else if (codepoint < 0x800) {
+					*out++ = (char)(0xC0 | (codepoint >> 6));
+					*out++ = (char)(0x80 | (codepoint & 0x3F));
+				} else if (codepoint < 0x10000) {
+					*out++ = (char)(0xE0 | (codepoint >> 12));
+					*out++ = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+					*out++ = (char)(0x80 | (codepoint & 0x3F));
+				} else {
+					*out++ = (char)(0xF0 | (codepoint >> 18));
+					*out++ = (char)(0x80 | ((codepoint >> 12) & 0x3F));
+					*out++ = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+					*out++ = (char)(0x80 | (codepoint & 0x3F));
+				}
+				break;
+			}
+			default:
+				// '"', '\\' and '/'
+				*out++ = c;
+				break;
+		}
+	}
+
+	return out - value;
+}
@@ -0,0 +1,102 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+#include <obs-data.h>
+
+// Read-only view over the top-level members of a JSON request, parsed in place.
+// parse() validates the whole payload in a single pass and indexes the
+// members of the root object without copying them; nested objects and arrays
+// are validated and skipped. String values are only unescaped (in place, in the
+// payload buffer) and NUL-terminated the first time they are read, so the
+// payload must not be parsed again afterwards. The index is allocated from the
+// current thread's RequestArena, so a view is only valid within its request.
+//
+// Types and conversions follow obs_data: JSON nulls count as missing members,
+// numbers without a fraction or exponent are integers, and reading a member
+// that is missing or of another type gives an empty string, false or 0.
+// Payloads jansson refuses (invalid UTF-8, integers out of the long long
+// range) are refused as well.
+class RequestView
+{
+public:
+	RequestView();
+
+	bool parse(std::string& payload);
+
+	obs_data_type type(const char* name) const;
+	obs_data_number_type numberType(const char* name) const;
+
+	// Raw bytes of a string member, escapes included. Doesn't modify the
+	// payload, unlike getString().
+	bool peekString(const char* name, const char*& value, size_t& length) const;
+
+	const char* getString(const char* name);
+	bool getBool(const char* name) const;
+	long long getInt(const char* name) const;
+	double getDouble(const char* name) const;
+
+	// Members in payload order, duplicates included, for reading all of them
+	// in a single pass. Names are raw (not terminated, escapes included).
+	size_t count() const {
+		return _count;
+	}
+	const char* nameAt(size_t index, size_t& length) const;
+	obs_data_type typeAt(size_t index) const;
+	obs_data_number_type numberTypeAt(size_t index) const;
+	const char* stringAt(size_t index);
+	bool boolAt(size_t index) const;
+	long long intAt(size_t index) const;
+	double doubleAt(size_t index) const;
+
+	// Decodes the escapes of a raw JSON string value in place, returning its
+	// new length. The escapes must be valid (as checked by parse()).
+	static size_t unescape(char* value, size_t length);
+
+private:
+	struct Member {
+		const char* name;
+		uint32_t nameLength;
+		obs_data_type type;
+		bool integer;
+		bool escaped;
+		bool terminated;
+		char* value;
+		uint32_t valueLength;
+	};
+
+	int find(const char* name) const;
+	void append(const Member& member);
+
+	bool parseValue(char*& pos, int depth, obs_data_type& type, bool& integer, bool& escaped);
+	bool parseContainer(char*& pos, int depth);
+	bool parseString(char*& pos, bool& escaped);
+	bool parseNumber(char*& pos, bool& integer);
+	bool parseLiteral(char*& pos, const char* literal, size_t length);
+	void skipWhitespace(char*& pos);
+
+	char* _end;
+	Member* _members;
+	size_t _count;
+	size_t _capacity;
+};
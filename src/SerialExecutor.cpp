@@ -0,0 +1,74 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <QtConcurrent/QtConcurrent>
+
+#include "SerialExecutor.h"
+
+// Maximum number of tasks run in a row before handing the worker thread back
+// to the pool, so that a client pipelining lots of requests can't starve others
+#define MAX_TASKS_PER_DRAIN 32
+
+SerialExecutor::SerialExecutor()
+	: _running(false)
+{
+}
+
+void SerialExecutor::post(QThreadPool* threadPool, std::function<void()> task)
+{
+	QMutexLocker locker(&_mutex);
+	_tasks.push_back(std::move(task));
+	if (_running) {
+		return;
+	}
+	_running = true;
+	locker.unlock();
+
+	auto self = shared_from_this();
+	QtConcurrent::run(threadPool, [self, threadPool]() {
+		self->drain(threadPool);
+	});
+}
+
+size_t SerialExecutor::pendingTasks()
+{
+	QMutexLocker locker(&_mutex);
+	return _tasks.size();
+}
+
+void SerialExecutor::drain(QThreadPool* threadPool)
+{
+	for (int i = 0; i < MAX_TASKS_PER_DRAIN; i++) {
+		QMutexLocker locker(&_mutex);
+		if (_tasks.empty()) {
+			_running = false;
+			return;
+		}
+		std::function<void()> task = std::move(_tasks.front());
+		_tasks.pop_front();
+		locker.unlock();
+
+		task();
+	}
+
+	// Still busy: requeue behind the other connections' work
+	auto self = shared_from_this();
+	QtConcurrent::run(threadPool, [self, threadPool]() {
+		self->drain(threadPool);
+	});
+}
@@ -0,0 +1,43 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <QtCore/QMutex>
+#include <QtCore/QThreadPool>
+
+// Strand over a QThreadPool: tasks posted to the same executor run one at a
+// time, in the order they were posted, while tasks of different executors
+// still run in parallel on the pool.
+class SerialExecutor : public std::enable_shared_from_this<SerialExecutor>
+{
+public:
+	explicit SerialExecutor();
+	void post(QThreadPool* threadPool, std::function<void()> task);
+	size_t pendingTasks();
+
+private:
+	void drain(QThreadPool* threadPool);
+
+	QMutex _mutex;
+	std::deque<std::function<void()>> _tasks;
+	bool _running;
+};
@@ -0,0 +1,84 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <util/platform.h>
+
+#include "TokenBucket.h"
+
+TokenBucket::TokenBucket()
+	: _tokens(-1.0),
+	  _lastRefill(0)
+{
+}
+
+bool TokenBucket::tryConsume(uint64_t rate)
+{
+	if (rate == 0) {
+		return true;
+	}
+
+	QMutexLocker locker(&_mutex);
+	if (!refill(rate, os_gettime_ns())) {
+		return false;
+	}
+
+	_tokens -= 1.0;
+	return true;
+}
+
+bool TokenBucket::tryConsume(TokenBucket& first, uint64_t firstRate,
+	TokenBucket& second, uint64_t secondRate)
+{
+	if (firstRate == 0) {
+		return second.tryConsume(secondRate);
+	}
+	if (secondRate == 0) {
+		return first.tryConsume(firstRate);
+	}
+
+	QMutexLocker firstLocker(&first._mutex);
+	QMutexLocker secondLocker(&second._mutex);
+
+	uint64_t now = os_gettime_ns();
+	if (!first.refill(firstRate, now) || !second.refill(secondRate, now)) {
+		return false;
+	}
+
+	first._tokens -= 1.0;
+	second._tokens -= 1.0;
+	return true;
+}
+
+bool TokenBucket::refill(uint64_t rate, uint64_t now)
+{
+	double capacity = (double)rate;
+
+	if (_tokens < 0.0) {
+		// First use: start with a full bucket
+		_tokens = capacity;
+	} else {
+		double elapsed = (double)(now - _lastRefill) / 1000000000.0;
+		_tokens += elapsed * capacity;
+		if (_tokens > capacity) {
+			_tokens = capacity;
+		}
+	}
+	_lastRefill = now;
+
+	return (_tokens >= 1.0);
+}
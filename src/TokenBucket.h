@@ -0,0 +1,46 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <QtCore/QMutex>
+
+// Token bucket refilled continuously at `rate` tokens per second, holding at
+// most one second worth of tokens. The rate is passed on each call so that
+// settings changes apply immediately. A rate of 0 means unlimited.
+class TokenBucket
+{
+public:
+	explicit TokenBucket();
+	bool tryConsume(uint64_t rate);
+
+	// Takes a token from both buckets, or from neither if either one is
+	// empty. Buckets are locked in argument order, so callers must always
+	// pass them in the same order.
+	static bool tryConsume(TokenBucket& first, uint64_t firstRate,
+		TokenBucket& second, uint64_t secondRate);
+
+private:
+	// Must be called with _mutex held. Returns whether a token is available.
+	bool refill(uint64_t rate, uint64_t now);
+
+	QMutex _mutex;
+	double _tokens;
+	uint64_t _lastRefill;
+};
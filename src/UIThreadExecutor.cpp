@@ -0,0 +1,115 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <atomic>
+#include <vector>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QMutex>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
+
+#include "UIThreadExecutor.h"
+
+struct PendingTask {
+	std::function<void()>* task;
+	QSemaphore* done;
+	bool* ran;
+};
+
+static QMutex queueMutex;
+static std::vector<PendingTask> queue;
+static bool drainScheduled = false;
+static bool shutDown = false;
+
+static std::atomic<uint64_t> taskCount(0);
+static std::atomic<uint64_t> invocationCount(0);
+
+bool UIThreadExecutor::run(std::function<void()> task)
+{
+	QCoreApplication* app = QCoreApplication::instance();
+	if (!app || QThread::currentThread() == app->thread()) {
+		task();
+		return true;
+	}
+
+	// All three live on this stack until done is released
+	QSemaphore done;
+	bool ran = false;
+	QMutexLocker locker(&queueMutex);
+	if (shutDown) {
+		return false;
+	}
+	queue.push_back({ &task, &done, &ran });
+	bool schedule = !drainScheduled;
+	drainScheduled = true;
+	locker.unlock();
+
+	taskCount++;
+
+	if (schedule) {
+		QTimer::singleShot(0, app, []() {
+			drain();
+		});
+	}
+	done.acquire();
+	return ran;
+}
+
+void UIThreadExecutor::shutdown()
+{
+	std::vector<PendingTask> tasks;
+	QMutexLocker locker(&queueMutex);
+	shutDown = true;
+	tasks.swap(queue);
+	locker.unlock();
+
+	for (PendingTask& pending : tasks) {
+		pending.done->release();
+	}
+}
+
+uint64_t UIThreadExecutor::tasks()
+{
+	return taskCount.load();
+}
+
+uint64_t UIThreadExecutor::invocations()
+{
+	return invocationCount.load();
+}
+
+void UIThreadExecutor::drain()
+{
+	invocationCount++;
+
+	// Tasks queued while these run wait for the next invocation, so that the
+	// event loop gets to process its own events in between
+	std::vector<PendingTask> tasks;
+	QMutexLocker locker(&queueMutex);
+	tasks.swap(queue);
+	drainScheduled = false;
+	locker.unlock();
+
+	for (PendingTask& pending : tasks) {
+		(*pending.task)();
+		*pending.ran = true;
+		pending.done->release();
+	}
+}
@@ -0,0 +1,47 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+
+// Runs work of the worker threads on the UI thread, where obs_frontend_* and
+// Qt widgets can be used safely. Tasks are queued, and a single queued
+// invocation per event loop turn runs all the tasks queued so far back to
+// back: concurrent requests that need the UI thread cost it one wakeup, not
+// one each.
+class UIThreadExecutor
+{
+public:
+	// Runs task on the UI thread and waits for it to finish. Called from the
+	// UI thread (or without a QCoreApplication), runs it right away. Returns
+	// false, without running the task, once shutdown() was called.
+	static bool run(std::function<void()> task);
+
+	// For when the UI event loop is gone or about to be: releases the tasks
+	// still queued without running them, and makes later run() calls fail
+	// right away, so that no worker waits forever for the UI thread.
+	static void shutdown();
+
+	static uint64_t tasks();
+	static uint64_t invocations();
+
+private:
+	static void drain();
+};
@@ -0,0 +1,63 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Length of the UTF-8 sequence starting at pos, a non-ASCII byte of a
+// NUL-terminated string, or 0 if it isn't valid UTF-8. Like jansson, rejects
+// overlong forms, surrogates and code points above U+10FFFF. Never reads past
+// the terminating NUL, which isn't a continuation byte.
+static inline size_t utf8SequenceLength(const char* pos)
+{
+	const unsigned char* bytes = (const unsigned char*)pos;
+	unsigned char lead = bytes[0];
+
+	size_t length;
+	uint32_t codepoint;
+	if (lead >= 0xC2 && lead <= 0xDF) {
+		length = 2;
+		codepoint = lead & 0x1F;
+	} else if (lead >= 0xE0 && lead <= 0xEF) {
+		length = 3;
+		codepoint = lead & 0x0F;
+	} else if (lead >= 0xF0 && lead <= 0xF4) {
+		length = 4;
+		codepoint = lead & 0x07;
+	} else {
+		return 0;
+	}
+
+	for (size_t i = 1; i < length; i++) {
+		if ((bytes[i] & 0xC0) != 0x80) {
+			return 0;
+		}
+		codepoint = (codepoint << 6) | (bytes[i] & 0x3F);
+	}
+
+	if ((length == 3 && codepoint < 0x800)
+		|| (length == 4 && codepoint < 0x10000)
+		|| (codepoint >= 0xD800 && codepoint <= 0xDFFF)
+		|| codepoint > 0x10FFFF)
+	{
+		return 0;
+	}
+	return length;
+}
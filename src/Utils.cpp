@@ -16,6 +16,16 @@ You should have received a copy of the GNU General Public License along
 with this program. If not, see <https://www.gnu.org/licenses/>
 */
 
+#ifdef _WIN32
+#include <windows.h>
+#include <bcrypt.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#endif
+
 #include <QtWidgets/QMainWindow>
 #include <QtCore/QDir>
 #include <QtCore/QUrl>
@@ -372,6 +382,8 @@ obs_data_t* Utils::GetSceneData(obs_source_t* source) {
 
 QSpinBox* Utils::GetTransitionDurationControl() {
 	QMainWindow* window = (QMainWindow*)obs_frontend_get_main_window();
+	if (!window) return nullptr;
+
 	return window->findChild<QSpinBox*>("transitionDuration");
 }
 
@@ -814,3 +826,42 @@ void Utils::PauseRecording(bool pause)
 
 	pauseRecording(pause); 
 }
+
+bool Utils::SecureRandomBytes(void* buffer, size_t size)
+{
+#ifdef _WIN32
+	NTSTATUS status = BCryptGenRandom(nullptr, (PUCHAR)buffer, (ULONG)size,
+		BCRYPT_USE_SYSTEM_PREFERRED_RNG);
+	if (!BCRYPT_SUCCESS(status)) {
+		blog(LOG_ERROR, "BCryptGenRandom failed: 0x%08lx", (unsigned long)status);
+		return false;
+	}
+	return true;
+#else
+	int fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		blog(LOG_ERROR, "can't open /dev/urandom: %s", strerror(errno));
+		return false;
+	}
+
+	uint8_t* pos = (uint8_t*)buffer;
+	size_t remaining = size;
+	while (remaining > 0) {
+		ssize_t count = read(fd, pos, remaining);
+		if (count < 0 && errno == EINTR) {
+			continue;
+		}
+		if (count <= 0) {
+			blog(LOG_ERROR, "can't read /dev/urandom: %s",
+				count < 0 ? strerror(errno) : "end of file");
+			close(fd);
+			return false;
+		}
+		pos += count;
+		remaining -= count;
+	}
+
+	close(fd);
+	return true;
+#endif
+}
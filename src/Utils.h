@@ -85,4 +85,8 @@ class Utils {
 	static bool RecordingPauseSupported();
 	static bool RecordingPaused();
 	static void PauseRecording(bool pause);
+
+	// Fills buffer from the operating system's CSPRNG. Returns false if it
+	// isn't available, in which case buffer must not be used.
+	static bool SecureRandomBytes(void* buffer, size_t size);
 };
@@ -24,6 +24,7 @@
 #include <QtWidgets/QPushButton>
 
 #include "Config.h"
+#include "JsonWriter.h"
 #include "Utils.h"
 #include "WSEvents.h"
 
@@ -71,6 +72,40 @@ const char* calldata_get_string(const calldata_t* data, const char* name) {
 	return value;
 }
 
+// These updates only carry the latest value of a fast-changing property:
+// a slow client can miss some of them without losing track of OBS' state.
+const char* droppableUpdateTypes[] = {
+	"SourceVolumeChanged",
+	"SceneItemTransformChanged",
+	"StreamStatus",
+	"Heartbeat"
+};
+
+bool isDroppableUpdate(const char* updateType) {
+	for (const char* droppableType : droppableUpdateTypes) {
+		if (strcmp(updateType, droppableType) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// Periodic status updates, superseded by the next one: not worth replaying
+// to a client resuming its session.
+const char* periodicUpdateTypes[] = {
+	"StreamStatus",
+	"Heartbeat"
+};
+
+bool isReplayableUpdate(const char* updateType) {
+	for (const char* periodicType : periodicUpdateTypes) {
+		if (strcmp(updateType, periodicType) == 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
 WSEvents::WSEvents(WSServerPtr srv) :
 	_srv(srv),
 	_streamStarttime(0),
@@ -83,8 +118,10 @@ WSEvents::WSEvents(WSServerPtr srv) :
 	obs_frontend_add_event_callback(WSEvents::FrontendEventHandler, this);
 
 	QSpinBox* durationControl = Utils::GetTransitionDurationControl();
-	connect(durationControl, SIGNAL(valueChanged(int)),
-		this, SLOT(TransitionDurationChanged(int)));
+	if (durationControl) {
+		connect(durationControl, SIGNAL(valueChanged(int)),
+			this, SLOT(TransitionDurationChanged(int)));
+	}
 
 	connect(&streamStatusTimer, SIGNAL(timeout()),
 		this, SLOT(StreamStatus()));
@@ -252,28 +289,40 @@ void WSEvents::FrontendEventHandler(enum obs_frontend_event event, void* private
 void WSEvents::broadcastUpdate(const char* updateType,
 	obs_data_t* additionalFields = nullptr)
 {
-	OBSDataAutoRelease update = obs_data_create();
-	obs_data_set_string(update, "update-type", updateType);
+	std::string json;
+	JsonWriter writer(json);
+	writer.beginObject();
+	writer.key("update-type");
+	writer.string(updateType);
 
 	if (obs_frontend_streaming_active()) {
 		QString streamingTimecode = getStreamingTimecode();
-		obs_data_set_string(update, "stream-timecode", streamingTimecode.toUtf8().constData());
+		writer.key("stream-timecode");
+		writer.string(streamingTimecode.toUtf8().constData());
 	}
 
 	if (obs_frontend_recording_active()) {
 		QString recordingTimecode = getRecordingTimecode();
-		obs_data_set_string(update, "rec-timecode", recordingTimecode.toUtf8().constData());
+		writer.key("rec-timecode");
+		writer.string(recordingTimecode.toUtf8().constData());
 	}
 
-	if (additionalFields)
-		obs_data_apply(update, additionalFields);
+	writer.members(additionalFields);
 
-	QString json = obs_data_get_json(update);
-	_srv->broadcast(json.toStdString());
+	QMutexLocker locker(&_broadcastMutex);
 
+	uint64_t sequence = _replayBuffer.nextSequence();
+	writer.key("update-seq");
+	writer.integer(sequence);
+	writer.endObject();
+
+	if (isReplayableUpdate(updateType)) {
+		_replayBuffer.store(sequence, json.c_str(), GetConfig()->EventReplayBufferSize);
+	}
 	if (GetConfig()->DebugEnabled) {
-		blog(LOG_INFO, "Update << '%s'", json.toUtf8().constData());
+		blog(LOG_INFO, "Update << '%s'", json.c_str());
 	}
+	_srv->broadcast(WSServer::makeTextMessage(std::move(json)), isDroppableUpdate(updateType));
 }
 
 void WSEvents::connectSourceSignals(obs_source_t* source) {
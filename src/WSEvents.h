@@ -24,10 +24,12 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include <util/platform.h>
 
 #include <QtWidgets/QListWidgetItem>
+#include <QtCore/QMutex>
 #include <QtCore/QSharedPointer>
 #include <QtCore/QTimer>
 
 #include "WSServer.h"
+#include "EventReplayBuffer.h"
 
 class WSEvents : public QObject
 {
@@ -50,6 +52,9 @@ public:
 	QString getRecordingTimecode();
 	
 	obs_data_t* GetStats();
+	EventReplayBuffer& replayBuffer() {
+		return _replayBuffer;
+	}
 
 	void OnBroadcastCustomMessage(QString realm, obs_data_t* data);
 
@@ -73,6 +78,11 @@ private:
 	uint64_t _lastBytesSent;
 	uint64_t _lastBytesSentTime;
 
+	EventReplayBuffer _replayBuffer;
+	// Keeps numbering, storage and broadcast of an update together so that
+	// clients receive updates in sequence order
+	QMutex _broadcastMutex;
+
 	void broadcastUpdate(const char* updateType,
 		obs_data_t* additionalFields);
 
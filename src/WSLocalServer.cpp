@@ -0,0 +1,286 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <util/platform.h>
+
+#include "WSLocalServer.h"
+#include "WSRequestHandler.h"
+#include "obs-websocket.h"
+#include "Config.h"
+#include "RateLimiter.h"
+
+#define MESSAGE_DELIMITER '\0'
+// Same as websocketpp's default max_message_size, which bounds websocket
+// requests
+#define MAX_MESSAGE_SIZE 32000000
+
+WSLocalServer::WSLocalServer(QThreadPool* threadPool)
+	: QObject(nullptr),
+	  _server(nullptr),
+	  _threadPool(threadPool),
+	  _nextClientId(1),
+	  _clientCount(0)
+{
+	connect(this, &WSLocalServer::broadcastRequested,
+		this, &WSLocalServer::onBroadcast, Qt::QueuedConnection);
+	connect(this, &WSLocalServer::responseReady,
+		this, &WSLocalServer::onResponse, Qt::QueuedConnection);
+}
+
+WSLocalServer::~WSLocalServer()
+{
+	stop();
+}
+
+bool WSLocalServer::start(QString socketPath)
+{
+	stop();
+
+#ifndef _WIN32
+	// Remove a socket file left behind by a previous instance that crashed,
+	// and nothing else: the path comes from the settings. Names that aren't
+	// absolute are resolved like QLocalServer does.
+	QString socketFile = QDir::isAbsolutePath(socketPath)
+		? socketPath
+		: QDir::tempPath() + QLatin1Char('/') + socketPath;
+	struct stat fileStat;
+	if (lstat(QFile::encodeName(socketFile).constData(), &fileStat) == 0) {
+		if (!S_ISSOCK(fileStat.st_mode)) {
+			blog(LOG_WARNING, "local server: %s exists and isn't a socket, not replacing it",
+				socketFile.toUtf8().constData());
+			return false;
+		}
+		QLocalServer::removeServer(socketPath);
+	}
+#endif
+
+	_server = new QLocalServer(this);
+	_server->setSocketOptions(QLocalServer::UserAccessOption);
+	connect(_server, &QLocalServer::newConnection,
+		this, &WSLocalServer::onNewConnection);
+
+	if (!_server->listen(socketPath)) {
+		blog(LOG_WARNING, "local server: listen on %s failed: %s",
+			socketPath.toUtf8().constData(),
+			_server->errorString().toUtf8().constData());
+		delete _server;
+		_server = nullptr;
+		return false;
+	}
+
+	blog(LOG_INFO, "local server listening on %s",
+		_server->fullServerName().toUtf8().constData());
+	return true;
+}
+
+void WSLocalServer::stop()
+{
+	if (!_server) {
+		return;
+	}
+
+	for (auto& entry : _clients) {
+		entry.second.socket->disconnect(this);
+		entry.second.socket->abort();
+		entry.second.socket->deleteLater();
+	}
+	_clients.clear();
+	_clientCount = 0;
+
+	_server->close();
+	delete _server;
+	_server = nullptr;
+
+	blog(LOG_INFO, "local server stopped");
+}
+
+void WSLocalServer::broadcast(const std::string& message, bool droppable)
+{
+	emit broadcastRequested(QByteArray(message.data(), (int)message.size()), droppable);
+}
+
+void WSLocalServer::onNewConnection()
+{
+	while (QLocalSocket* socket = _server->nextPendingConnection()) {
+		quint64 clientId = _nextClientId++;
+
+		LocalClient& client = _clients[clientId];
+		client.socket = socket;
+		client.properties = std::make_shared<ConnectionProperties>();
+		_clientCount = (int)_clients.size();
+
+		connect(socket, &QLocalSocket::readyRead, this, [=]() {
+			onReadyRead(clientId);
+		});
+		connect(socket, &QLocalSocket::disconnected, this, [=]() {
+			onDisconnected(clientId);
+		});
+
+		blog(LOG_INFO, "new local client connection (id %llu)",
+			(unsigned long long)clientId);
+	}
+}
+
+void WSLocalServer::onReadyRead(quint64 clientId)
+{
+	auto it = _clients.find(clientId);
+	if (it == _clients.end()) {
+		return;
+	}
+
+	LocalClient& client = it->second;
+	client.readBuffer.append(client.socket->readAll());
+
+	int delimiterPos;
+	while ((delimiterPos = client.readBuffer.indexOf(MESSAGE_DELIMITER)) >= 0) {
+		QByteArray request = client.readBuffer.left(delimiterPos);
+		client.readBuffer.remove(0, delimiterPos + 1);
+
+		if (request.isEmpty()) {
+			continue;
+		}
+
+		std::string payload(request.constData(), request.size());
+
+		std::shared_ptr<ConnectionProperties> properties = client.properties;
+		if (properties->requestExecutor()->pendingTasks() >= MAX_QUEUED_TASKS) {
+			blog(LOG_WARNING, "disconnecting local client %llu: request queue limit exceeded",
+				(unsigned long long)clientId);
+			client.socket->abort();
+			return;
+		}
+
+		// The thread pool and this object belong to the server: keep it
+		// alive until the request is done
+		WSServerPtr server = GetServer();
+
+		std::string rejectionResponse;
+		if (!RateLimiter::admitRequest(*properties, payload, rejectionResponse)) {
+			// Queued behind the requests received before it, like responses
+			properties->requestExecutor()->post(_threadPool,
+				[this, server, clientId, rejectionResponse]()
+			{
+				emit responseReady(clientId,
+					QByteArray(rejectionResponse.data(), (int)rejectionResponse.size()));
+			});
+			continue;
+		}
+
+		uint64_t receivedAt = os_gettime_ns();
+		properties->requestExecutor()->post(_threadPool,
+			[this, server, properties, clientId, payload, receivedAt]() mutable
+		{
+			WSRequestHandler handler(*properties);
+			std::string response = handler.processIncomingMessage(payload, receivedAt);
+
+			emit responseReady(clientId, QByteArray(response.data(), (int)response.size()));
+		});
+	}
+
+	// What's left is an incomplete message
+	if (client.readBuffer.size() > MAX_MESSAGE_SIZE) {
+		blog(LOG_WARNING, "disconnecting local client %llu: message too big",
+			(unsigned long long)clientId);
+		client.socket->abort();
+	}
+}
+
+void WSLocalServer::onDisconnected(quint64 clientId)
+{
+	auto it = _clients.find(clientId);
+	if (it == _clients.end()) {
+		return;
+	}
+
+	it->second.socket->deleteLater();
+	_clients.erase(it);
+	_clientCount = (int)_clients.size();
+
+	blog(LOG_INFO, "local client disconnected (id %llu)",
+		(unsigned long long)clientId);
+}
+
+void WSLocalServer::onBroadcast(QByteArray message, bool droppable)
+{
+	bool authRequired = GetConfig()->AuthRequired;
+
+	std::vector<quint64> evicted;
+	for (auto& entry : _clients) {
+		LocalClient& client = entry.second;
+		if (authRequired && !client.properties->isAuthenticated()) {
+			continue;
+		}
+
+		if (!write(client, message, droppable)) {
+			evicted.push_back(entry.first);
+		}
+	}
+
+	for (quint64 clientId : evicted) {
+		auto it = _clients.find(clientId);
+		if (it != _clients.end()) {
+			it->second.socket->abort();
+		}
+	}
+}
+
+void WSLocalServer::onResponse(quint64 clientId, QByteArray response)
+{
+	auto it = _clients.find(clientId);
+	if (it == _clients.end()) {
+		return;
+	}
+
+	if (!write(it->second, response, false)) {
+		it->second.socket->abort();
+	}
+}
+
+// Applies the same outbound limits as websocket clients. Returns false if
+// the client must be disconnected.
+bool WSLocalServer::write(LocalClient& client, const QByteArray& message, bool droppable)
+{
+	auto config = GetConfig();
+	uint64_t bytesToWrite = client.socket->bytesToWrite();
+
+	// As for websocket clients, non-droppable messages are sent however large
+	// they are: only what's already queued counts against the limit for them
+	uint64_t pendingBytes = droppable ? (uint64_t)message.size() : 0;
+	if (bytesToWrite + pendingBytes > config->OutboundQueueLimit) {
+		blog(LOG_WARNING, "local server: evicting slow client (%llu bytes buffered)",
+			(unsigned long long)bytesToWrite);
+		return false;
+	}
+
+	if (droppable && bytesToWrite > config->OutboundHighWaterMark) {
+		client.properties->addDroppedMessage();
+		return true;
+	}
+
+	client.socket->write(message);
+	client.socket->putChar(MESSAGE_DELIMITER);
+	return true;
+}
@@ -0,0 +1,77 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <QtCore/QObject>
+#include <QtCore/QByteArray>
+#include <QtCore/QThreadPool>
+#include <QtNetwork/QLocalServer>
+#include <QtNetwork/QLocalSocket>
+
+#include "ConnectionProperties.h"
+
+// Same-host transport: serves the request/event protocol over a local socket
+// (Unix domain socket, or named pipe on Windows) without websocket framing.
+// Each message is a JSON document terminated by a NUL byte, in both directions.
+// Lives on its own thread; broadcast() may be called from any thread.
+class WSLocalServer : public QObject
+{
+Q_OBJECT
+
+public:
+	explicit WSLocalServer(QThreadPool* threadPool);
+	virtual ~WSLocalServer();
+	void broadcast(const std::string& message, bool droppable);
+	int clientCount() {
+		return _clientCount.load();
+	}
+
+public slots:
+	bool start(QString socketPath);
+	void stop();
+
+signals:
+	void broadcastRequested(QByteArray message, bool droppable);
+	void responseReady(quint64 clientId, QByteArray response);
+
+private slots:
+	void onNewConnection();
+	void onBroadcast(QByteArray message, bool droppable);
+	void onResponse(quint64 clientId, QByteArray response);
+
+private:
+	struct LocalClient {
+		QLocalSocket* socket;
+		QByteArray readBuffer;
+		std::shared_ptr<ConnectionProperties> properties;
+	};
+
+	void onReadyRead(quint64 clientId);
+	void onDisconnected(quint64 clientId);
+	bool write(LocalClient& client, const QByteArray& message, bool droppable);
+
+	QLocalServer* _server;
+	QThreadPool* _threadPool;
+	std::map<quint64, LocalClient> _clients;
+	quint64 _nextClientId;
+	std::atomic<int> _clientCount;
+};
@@ -17,158 +17,100 @@
  * with this program. If not, see <https://www.gnu.org/licenses/>
  */
 
+#include <string.h>
+
 #include <obs-data.h>
+#include <util/platform.h>
 
 #include "Config.h"
+#include "JsonWriter.h"
+#include "RequestArena.h"
+#include "RequestStats.h"
+#include "UIThreadExecutor.h"
 #include "Utils.h"
 
 #include "WSRequestHandler.h"
 
-QHash<QString, HandlerResponse(*)(WSRequestHandler*)> WSRequestHandler::messageMap{
-	{ "GetVersion", WSRequestHandler::HandleGetVersion },
-	{ "GetAuthRequired", WSRequestHandler::HandleGetAuthRequired },
-	{ "Authenticate", WSRequestHandler::HandleAuthenticate },
-
-	{ "GetStats", WSRequestHandler::HandleGetStats },
-	{ "SetHeartbeat", WSRequestHandler::HandleSetHeartbeat },
-	{ "GetVideoInfo", WSRequestHandler::HandleGetVideoInfo },
-
-	{ "SetFilenameFormatting", WSRequestHandler::HandleSetFilenameFormatting },
-	{ "GetFilenameFormatting", WSRequestHandler::HandleGetFilenameFormatting },
-
-	{ "BroadcastCustomMessage", WSRequestHandler::HandleBroadcastCustomMessage },
-
-	{ "SetCurrentScene", WSRequestHandler::HandleSetCurrentScene },
-	{ "GetCurrentScene", WSRequestHandler::HandleGetCurrentScene },
-	{ "GetSceneList", WSRequestHandler::HandleGetSceneList },
-
-	{ "SetSourceRender", WSRequestHandler::HandleSetSceneItemRender }, // Retrocompat
-	{ "SetSceneItemRender", WSRequestHandler::HandleSetSceneItemRender },
-	{ "SetSceneItemPosition", WSRequestHandler::HandleSetSceneItemPosition },
-	{ "SetSceneItemTransform", WSRequestHandler::HandleSetSceneItemTransform },
-	{ "SetSceneItemCrop", WSRequestHandler::HandleSetSceneItemCrop },
-	{ "GetSceneItemProperties", WSRequestHandler::HandleGetSceneItemProperties },
-	{ "SetSceneItemProperties", WSRequestHandler::HandleSetSceneItemProperties },
-	{ "ResetSceneItem", WSRequestHandler::HandleResetSceneItem },
-	{ "DeleteSceneItem", WSRequestHandler::HandleDeleteSceneItem },
-	{ "DuplicateSceneItem", WSRequestHandler::HandleDuplicateSceneItem },
-	{ "ReorderSceneItems", WSRequestHandler::HandleReorderSceneItems },
-
-	{ "GetStreamingStatus", WSRequestHandler::HandleGetStreamingStatus },
-	{ "StartStopStreaming", WSRequestHandler::HandleStartStopStreaming },
-	{ "StartStopRecording", WSRequestHandler::HandleStartStopRecording },
-
-	{ "StartStreaming", WSRequestHandler::HandleStartStreaming },
-	{ "StopStreaming", WSRequestHandler::HandleStopStreaming },
-
-	{ "StartRecording", WSRequestHandler::HandleStartRecording },
-	{ "StopRecording", WSRequestHandler::HandleStopRecording },
-	{ "PauseRecording", WSRequestHandler::HandlePauseRecording },
-	{ "ResumeRecording", WSRequestHandler::HandleResumeRecording },
-
-	{ "StartStopReplayBuffer", WSRequestHandler::HandleStartStopReplayBuffer },
-	{ "StartReplayBuffer", WSRequestHandler::HandleStartReplayBuffer },
-	{ "StopReplayBuffer", WSRequestHandler::HandleStopReplayBuffer },
-	{ "SaveReplayBuffer", WSRequestHandler::HandleSaveReplayBuffer },
-
-	{ "SetRecordingFolder", WSRequestHandler::HandleSetRecordingFolder },
-	{ "GetRecordingFolder", WSRequestHandler::HandleGetRecordingFolder },
-
-	{ "GetTransitionList", WSRequestHandler::HandleGetTransitionList },
-	{ "GetCurrentTransition", WSRequestHandler::HandleGetCurrentTransition },
-	{ "SetCurrentTransition", WSRequestHandler::HandleSetCurrentTransition },
-	{ "SetTransitionDuration", WSRequestHandler::HandleSetTransitionDuration },
-	{ "GetTransitionDuration", WSRequestHandler::HandleGetTransitionDuration },
-
-	{ "SetVolume", WSRequestHandler::HandleSetVolume },
-	{ "GetVolume", WSRequestHandler::HandleGetVolume },
-	{ "ToggleMute", WSRequestHandler::HandleToggleMute },
-	{ "SetMute", WSRequestHandler::HandleSetMute },
-	{ "GetMute", WSRequestHandler::HandleGetMute },
-	{ "SetSyncOffset", WSRequestHandler::HandleSetSyncOffset },
-	{ "GetSyncOffset", WSRequestHandler::HandleGetSyncOffset },
-	{ "GetSpecialSources", WSRequestHandler::HandleGetSpecialSources },
-	{ "GetSourcesList", WSRequestHandler::HandleGetSourcesList },
-	{ "GetSourceTypesList", WSRequestHandler::HandleGetSourceTypesList },
-	{ "GetSourceSettings", WSRequestHandler::HandleGetSourceSettings },
-	{ "SetSourceSettings", WSRequestHandler::HandleSetSourceSettings },
-	{ "TakeSourceScreenshot", WSRequestHandler::HandleTakeSourceScreenshot },
-
-	{ "GetSourceFilters", WSRequestHandler::HandleGetSourceFilters },
-	{ "AddFilterToSource", WSRequestHandler::HandleAddFilterToSource },
-	{ "RemoveFilterFromSource", WSRequestHandler::HandleRemoveFilterFromSource },
-	{ "ReorderSourceFilter", WSRequestHandler::HandleReorderSourceFilter },
-	{ "MoveSourceFilter", WSRequestHandler::HandleMoveSourceFilter },
-	{ "SetSourceFilterSettings", WSRequestHandler::HandleSetSourceFilterSettings },
-
-	{ "SetCurrentSceneCollection", WSRequestHandler::HandleSetCurrentSceneCollection },
-	{ "GetCurrentSceneCollection", WSRequestHandler::HandleGetCurrentSceneCollection },
-	{ "ListSceneCollections", WSRequestHandler::HandleListSceneCollections },
-
-	{ "SetCurrentProfile", WSRequestHandler::HandleSetCurrentProfile },
-	{ "GetCurrentProfile", WSRequestHandler::HandleGetCurrentProfile },
-	{ "ListProfiles", WSRequestHandler::HandleListProfiles },
-
-	{ "SetStreamSettings", WSRequestHandler::HandleSetStreamSettings },
-	{ "GetStreamSettings", WSRequestHandler::HandleGetStreamSettings },
-	{ "SaveStreamSettings", WSRequestHandler::HandleSaveStreamSettings },
-#if BUILD_CAPTIONS
-	{ "SendCaptions", WSRequestHandler::HandleSendCaptions },
-#endif
-
-	{ "GetStudioModeStatus", WSRequestHandler::HandleGetStudioModeStatus },
-	{ "GetPreviewScene", WSRequestHandler::HandleGetPreviewScene },
-	{ "SetPreviewScene", WSRequestHandler::HandleSetPreviewScene },
-	{ "TransitionToProgram", WSRequestHandler::HandleTransitionToProgram },
-	{ "EnableStudioMode", WSRequestHandler::HandleEnableStudioMode },
-	{ "DisableStudioMode", WSRequestHandler::HandleDisableStudioMode },
-	{ "ToggleStudioMode", WSRequestHandler::HandleToggleStudioMode },
-
-	{ "SetTextGDIPlusProperties", WSRequestHandler::HandleSetTextGDIPlusProperties },
-	{ "GetTextGDIPlusProperties", WSRequestHandler::HandleGetTextGDIPlusProperties },
-
-	{ "SetTextFreetype2Properties", WSRequestHandler::HandleSetTextFreetype2Properties },
-	{ "GetTextFreetype2Properties", WSRequestHandler::HandleGetTextFreetype2Properties },
-
-	{ "GetBrowserSourceProperties", WSRequestHandler::HandleGetBrowserSourceProperties },
-	{ "SetBrowserSourceProperties", WSRequestHandler::HandleSetBrowserSourceProperties },
-
-	{ "ListOutputs", WSRequestHandler::HandleListOutputs },
-	{ "GetOutputInfo", WSRequestHandler::HandleGetOutputInfo },
-	{ "StartOutput", WSRequestHandler::HandleStartOutput },
-	{ "StopOutput", WSRequestHandler::HandleStopOutput },
-
-	{ "GetSourceTypeDefaults",WSRequestHandler::HandleGetSourceTypeDefaults },
-	{ "AddNewSourceToScene",WSRequestHandler::HandleAddNewSourceToScene },
-	{ "RemoveSourceFromScene",WSRequestHandler::HandleRemoveSourceFromScene },
-
-	{ "SetSceneItemOrder",WSRequestHandler::HandleSetSceneItemOrder },
-	{ "GetScene",WSRequestHandler::HandleGetScene },
-	{ "SetSceneItemIndex",WSRequestHandler::HandleSetSceneItemIndex }
+// FNV-1a, evaluated at compile time for the case labels of findRequestType()
+static constexpr uint32_t hashRequestType(const char* name, uint32_t hash = 2166136261u) {
+	return *name
+		? hashRequestType(name + 1, (hash ^ (uint8_t)*name) * 16777619u)
+		: hash;
+}
 
+enum RequestTypeIndex {
+#define REQUEST_TYPE(name, handler, flags, affinity) RequestTypeIndex_##name,
+#include "WSRequestHandler_List.h"
+#undef REQUEST_TYPE
+	RequestTypeCount
 };
 
-QSet<QString> WSRequestHandler::authNotRequired {
-	"GetVersion",
-	"GetAuthRequired",
-	"Authenticate"
+const WSRequestHandler::RequestType WSRequestHandler::requestTypes[] = {
+#define REQUEST_TYPE(name, handler, flags, affinity) { #name, handler, flags, affinity },
+#include "WSRequestHandler_List.h"
+#undef REQUEST_TYPE
 };
 
+const size_t WSRequestHandler::requestTypeCount = RequestTypeCount;
+
+// One slot per request type, and a last one for requests without a known type
+static RequestStats requestStats[RequestTypeCount + 1];
+
+// The hashes of all request types are case labels of a single switch, so any
+// collision is a compile error and each hash maps to exactly one entry. An
+// unknown name only costs the hash and at most one comparison.
+const WSRequestHandler::RequestType* WSRequestHandler::findRequestType(const char* name) {
+	return findRequestType(name, strlen(name));
+}
+
+const WSRequestHandler::RequestType* WSRequestHandler::findRequestType(const char* name, size_t length) {
+	// Same as hashRequestType(), over a string that isn't NUL-terminated
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < length; i++) {
+		hash = (hash ^ (uint8_t)name[i]) * 16777619u;
+	}
+
+	switch (hash) {
+#define REQUEST_TYPE(requestName, handler, flags, affinity) \
+		case hashRequestType(#requestName): \
+			return (length == sizeof(#requestName) - 1 \
+				&& memcmp(name, #requestName, length) == 0) \
+				? &requestTypes[RequestTypeIndex_##requestName] : nullptr;
+#include "WSRequestHandler_List.h"
+#undef REQUEST_TYPE
+		default:
+			return nullptr;
+	}
+}
+
 WSRequestHandler::WSRequestHandler(ConnectionProperties& connProperties) :
 	_messageId(0),
 	_requestType(""),
+	_responseStatus("ok"),
 	data(nullptr),
-	_connProperties(connProperties)
+	_connProperties(connProperties),
+	_dispatchedType(nullptr),
+	_handlerStartTime(0)
 {
 }
 
-std::string WSRequestHandler::processIncomingMessage(std::string& textMessage) {
+std::string WSRequestHandler::processIncomingMessage(std::string& textMessage, uint64_t receivedAt) {
 	if (GetConfig()->DebugEnabled) {
 		blog(LOG_INFO, "Request >> '%s'", textMessage.c_str());
 	}
 
-	OBSDataAutoRelease responseData = processRequest(textMessage);
-	std::string response = obs_data_get_json(responseData);
+	uint64_t startTime = os_gettime_ns();
+	RequestArena::Scope arenaScope;
+
+	OBSDataAutoRelease responseFields = processRequest(textMessage);
+	uint64_t processedTime = os_gettime_ns();
+
+	// Written in the thread's reusable buffer, then copied once at its final size
+	std::string& responseBuffer = RequestArena::current().responseBuffer();
+	writeResponse(responseBuffer, responseFields);
+	std::string response(responseBuffer);
+
+	recordStats(receivedAt, startTime, processedTime);
 
 	if (GetConfig()->DebugEnabled) {
 		blog(LOG_INFO, "Response << '%s'", response.c_str());
@@ -177,36 +119,128 @@ std::string WSRequestHandler::processIncomingMessage(std::string& textMessage) {
 	return response;
 }
 
-HandlerResponse WSRequestHandler::processRequest(std::string& textMessage){
-	std::string msgContainer(textMessage);
-	const char* msg = msgContainer.c_str();
+// Records the request in the stats of its type, or of invalid requests.
+// Serialization is taken to have ended now; receivedAt is 0 for requests that
+// weren't queued.
+void WSRequestHandler::recordStats(uint64_t receivedAt, uint64_t startTime, uint64_t processedTime) {
+	uint64_t durations[RequestStats::StageCount] = {};
+	if (receivedAt && receivedAt < startTime) {
+		durations[RequestStats::QueueWait] = startTime - receivedAt;
+	}
+	if (_handlerStartTime) {
+		durations[RequestStats::Parse] = _handlerStartTime - startTime;
+		durations[RequestStats::Handler] = processedTime - _handlerStartTime;
+	} else {
+		durations[RequestStats::Parse] = processedTime - startTime;
+	}
+	durations[RequestStats::Serialize] = os_gettime_ns() - processedTime;
 
-	data = obs_data_create_from_json(msg);
-	if (!data) {
-		blog(LOG_ERROR, "invalid JSON payload received for '%s'", msg);
+	size_t statsSlot = _dispatchedType ? (size_t)(_dispatchedType - requestTypes) : RequestTypeCount;
+	requestStats[statsSlot].record(strcmp(_responseStatus, "error") == 0, durations);
+}
+
+HandlerResponse WSRequestHandler::processRequest(std::string& textMessage){
+	// Validates and indexes the payload without modifying it yet
+	if (!_view.parse(textMessage)) {
+		blog(LOG_ERROR, "invalid JSON payload received for '%s'", textMessage.c_str());
 		return SendErrorResponse("invalid JSON payload");
 	}
 
+	const char* requestTypeName;
+	size_t requestTypeLength;
+	const RequestType* requestType = nullptr;
+	if (_view.peekString("request-type", requestTypeName, requestTypeLength)) {
+		requestType = findRequestType(requestTypeName, requestTypeLength);
+	}
+
+	// Handlers that weren't ported to the view (and error responses) get
+	// their parameters as obs_data, as before
+	if (!requestType || !(requestType->flags & InPlaceParameters)) {
+		data = obs_data_create_from_json(textMessage.c_str());
+		if (!data) {
+			blog(LOG_ERROR, "invalid JSON payload received for '%s'", textMessage.c_str());
+			return SendErrorResponse("invalid JSON payload");
+		}
+	}
+
+	return dispatchRequest();
+}
+
+HandlerResponse WSRequestHandler::dispatchRequest() {
 	if (!hasField("request-type") || !hasField("message-id")) {
 		return SendErrorResponse("missing request parameters");
 	}
 
-	_requestType = obs_data_get_string(data, "request-type");
-	_messageId = obs_data_get_string(data, "message-id");
+	_requestType = getString("request-type");
+	_messageId = getString("message-id");
+
+	const RequestType* requestType = findRequestType(_requestType);
+	_dispatchedType = requestType;
 
 	if (GetConfig()->AuthRequired
-		&& (!authNotRequired.contains(_requestType))
+		&& (!requestType || !(requestType->flags & AuthNotRequired))
 		&& (!_connProperties.isAuthenticated()))
 	{
 		return SendErrorResponse("Not Authenticated");
 	}
 
-	HandlerResponse (*handlerFunc)(WSRequestHandler*) = (messageMap[_requestType]);
-	if (!handlerFunc) {
+	if (!requestType) {
 		return SendErrorResponse("invalid request type");
 	}
 
-	return handlerFunc(this);
+	_handlerStartTime = os_gettime_ns();
+	return runHandler(requestType);
+}
+
+HandlerResponse WSRequestHandler::runHandler(const RequestType* requestType) {
+	HandlerResponse response = nullptr;
+	switch (requestType->affinity) {
+		case UIThread: {
+			bool ran = UIThreadExecutor::run([this, requestType, &response]() {
+				// Scratch allocations made on the UI thread are released
+				// with the handler, the request's own memory stays in the
+				// worker's arena
+				RequestArena::Scope arenaScope;
+				response = requestType->handler(this);
+			});
+			if (!ran) {
+				response = SendErrorResponse("OBS is shutting down");
+			}
+			break;
+		}
+
+		// libobs has no way to post work to its graphics thread: these
+		// handlers enter the graphics context themselves, around the GPU work
+		// only, so that the graphics thread isn't held while they run the rest
+		case GraphicsThread:
+		default:
+			response = requestType->handler(this);
+			break;
+	}
+	return response;
+}
+
+obs_data_t* WSRequestHandler::GetRequestTypeStats() {
+	obs_data_t* stats = obs_data_create();
+	for (size_t i = 0; i < requestTypeCount; i++) {
+		if (!requestStats[i].requests()) {
+			continue;
+		}
+
+		OBSDataAutoRelease typeStats = requestStats[i].summary();
+		obs_data_set_obj(stats, requestTypes[i].name, typeStats);
+	}
+	return stats;
+}
+
+obs_data_t* WSRequestHandler::GetInvalidRequestStats() {
+	return requestStats[RequestTypeCount].summary();
+}
+
+void WSRequestHandler::ResetRequestStats() {
+	for (RequestStats& stats : requestStats) {
+		stats.reset();
+	}
 }
 
 WSRequestHandler::~WSRequestHandler() {
@@ -228,9 +262,30 @@ HandlerResponse WSRequestHandler::SendErrorResponse(obs_data_t* additionalFields
 }
 
 HandlerResponse WSRequestHandler::SendResponse(const char* status, obs_data_t* fields) {
+	// message-id and status are only added when the response is written
+	_responseStatus = status;
+
+	if (fields) {
+		obs_data_addref(fields);
+	}
+	return fields;
+}
+
+void WSRequestHandler::writeResponse(std::string& buffer, obs_data_t* fields) {
+	JsonWriter writer(buffer);
+	writer.beginObject();
+	writer.key("message-id");
+	writer.string(_messageId);
+	writer.key("status");
+	writer.string(_responseStatus);
+	writer.members(fields);
+	writer.endObject();
+}
+
+obs_data_t* WSRequestHandler::responseData(obs_data_t* fields) {
 	obs_data_t* response = obs_data_create();
 	obs_data_set_string(response, "message-id", _messageId);
-	obs_data_set_string(response, "status", status);
+	obs_data_set_string(response, "status", _responseStatus);
 
 	if (fields) {
 		obs_data_apply(response, fields);
@@ -239,24 +294,37 @@ HandlerResponse WSRequestHandler::SendResponse(const char* status, obs_data_t* f
 	return response;
 }
 
-bool WSRequestHandler::hasField(QString name, obs_data_type expectedFieldType, obs_data_number_type expectedNumberType) {
-	if (!data || name.isEmpty() || name.isNull()) {
+bool WSRequestHandler::hasField(const char* name, obs_data_type expectedFieldType, obs_data_number_type expectedNumberType) {
+	if (!name || !*name) {
 		return false;
 	}
 
-	OBSDataItemAutoRelease dataItem = obs_data_item_byname(data, name.toUtf8());
-	if (!dataItem) {
-		return false;
+	obs_data_type fieldType;
+	obs_data_number_type numberType = OBS_DATA_NUM_INVALID;
+	if (data) {
+		OBSDataItemAutoRelease dataItem = obs_data_item_byname(data, name);
+		if (!dataItem) {
+			return false;
+		}
+
+		fieldType = obs_data_item_gettype(dataItem);
+		if (fieldType == OBS_DATA_NUMBER) {
+			numberType = obs_data_item_numtype(dataItem);
+		}
+	} else {
+		fieldType = _view.type(name);
+		if (fieldType == OBS_DATA_NULL) {
+			return false;
+		}
+		numberType = _view.numberType(name);
 	}
 
 	if (expectedFieldType != OBS_DATA_NULL) {
-		obs_data_type fieldType = obs_data_item_gettype(dataItem);
 		if (fieldType != expectedFieldType) {
 			return false;
 		}
 
 		if (fieldType == OBS_DATA_NUMBER && expectedNumberType != OBS_DATA_NUM_INVALID) {
-			obs_data_number_type numberType = obs_data_item_numtype(dataItem);
 			if (numberType != expectedNumberType) {
 				return false;
 			}
@@ -266,30 +334,194 @@ bool WSRequestHandler::hasField(QString name, obs_data_type expectedFieldType, o
 	return true;
 }
 
-bool WSRequestHandler::hasBool(QString fieldName) {
+bool WSRequestHandler::hasBool(const char* fieldName) {
 	return this->hasField(fieldName, OBS_DATA_BOOLEAN);
 }
 
-bool WSRequestHandler::hasString(QString fieldName) {
+bool WSRequestHandler::hasString(const char* fieldName) {
 	return this->hasField(fieldName, OBS_DATA_STRING);
 }
 
-bool WSRequestHandler::hasNumber(QString fieldName, obs_data_number_type expectedNumberType) {
+bool WSRequestHandler::hasNumber(const char* fieldName, obs_data_number_type expectedNumberType) {
 	return this->hasField(fieldName, OBS_DATA_NUMBER, expectedNumberType);
 }
 
-bool WSRequestHandler::hasInteger(QString fieldName) {
+bool WSRequestHandler::hasInteger(const char* fieldName) {
 	return this->hasNumber(fieldName, OBS_DATA_NUM_INT);
 }
 
-bool WSRequestHandler::hasDouble(QString fieldName) {
+bool WSRequestHandler::hasDouble(const char* fieldName) {
 	return this->hasNumber(fieldName, OBS_DATA_NUM_DOUBLE);
 }
 
-bool WSRequestHandler::hasArray(QString fieldName) {
+bool WSRequestHandler::hasArray(const char* fieldName) {
 	return this->hasField(fieldName, OBS_DATA_ARRAY);
 }
 
-bool WSRequestHandler::hasObject(QString fieldName) {
+bool WSRequestHandler::hasObject(const char* fieldName) {
 	return this->hasField(fieldName, OBS_DATA_OBJECT);
 }
+
+const char* WSRequestHandler::getString(const char* fieldName) {
+	return data ? obs_data_get_string(data, fieldName) : _view.getString(fieldName);
+}
+
+bool WSRequestHandler::getBool(const char* fieldName) {
+	return data ? obs_data_get_bool(data, fieldName) : _view.getBool(fieldName);
+}
+
+long long WSRequestHandler::getInt(const char* fieldName) {
+	return data ? obs_data_get_int(data, fieldName) : _view.getInt(fieldName);
+}
+
+double WSRequestHandler::getDouble(const char* fieldName) {
+	return data ? obs_data_get_double(data, fieldName) : _view.getDouble(fieldName);
+}
+
+static int findParameter(const RequestSchema& schema, const char* name, size_t length) {
+	for (size_t i = 0; i < schema.count; i++) {
+		const RequestParameter& parameter = schema.parameters[i];
+		if (parameter.nameLength == length && memcmp(parameter.name, name, length) == 0) {
+			return (int)i;
+		}
+	}
+	return -1;
+}
+
+const char* WSRequestHandler::readParameters(const RequestSchema& schema, void* params) {
+	char* base = (char*)params;
+	for (size_t i = 0; i < schema.count; i++) {
+		const RequestParameter& parameter = schema.parameters[i];
+		switch (parameter.type) {
+			case OBS_DATA_STRING:
+				*(const char**)(base + parameter.offset) = "";
+				break;
+			case OBS_DATA_NUMBER:
+				if (parameter.numberType == OBS_DATA_NUM_INT) {
+					*(long long*)(base + parameter.offset) = 0;
+				} else {
+					*(double*)(base + parameter.offset) = 0.0;
+				}
+				break;
+			case OBS_DATA_BOOLEAN:
+				*(bool*)(base + parameter.offset) = false;
+				break;
+			case OBS_DATA_OBJECT:
+				*(obs_data_t**)(base + parameter.offset) = nullptr;
+				break;
+			case OBS_DATA_ARRAY:
+				*(obs_data_array_t**)(base + parameter.offset) = nullptr;
+				break;
+			default:
+				break;
+		}
+		if (parameter.optional) {
+			*(bool*)(base + parameter.presentOffset) = false;
+		}
+	}
+
+	// One bit per parameter of the schema
+	uint64_t present = 0;
+	uint64_t mistyped = 0;
+
+	// Single pass over the members of the request, whichever way it was parsed.
+	// Later duplicates overwrite earlier ones, as they do in obs_data.
+	size_t viewIndex = 0;
+	obs_data_item_t* dataItem = data ? obs_data_first(data) : nullptr;
+	while (data ? dataItem != nullptr : viewIndex < _view.count()) {
+		const char* name;
+		size_t length;
+		obs_data_type type;
+		if (data) {
+			name = obs_data_item_get_name(dataItem);
+			length = strlen(name);
+			type = obs_data_item_gettype(dataItem);
+		} else {
+			name = _view.nameAt(viewIndex, length);
+			type = _view.typeAt(viewIndex);
+		}
+
+		int index = findParameter(schema, name, length);
+		if (index >= 0 && type != OBS_DATA_NULL) {
+			const RequestParameter& parameter = schema.parameters[index];
+			uint64_t bit = 1ULL << index;
+			void* value = base + parameter.offset;
+
+			// Objects and arrays aren't indexed by the in-place view
+			bool readable = (type == parameter.type)
+				&& (data || (type != OBS_DATA_OBJECT && type != OBS_DATA_ARRAY));
+			if (!readable) {
+				mistyped |= bit;
+				present &= ~bit;
+			} else {
+				mistyped &= ~bit;
+				present |= bit;
+
+				switch (type) {
+					case OBS_DATA_STRING:
+						*(const char**)value = data
+							? obs_data_item_get_string(dataItem)
+							: _view.stringAt(viewIndex);
+						break;
+					case OBS_DATA_NUMBER:
+						// Either kind of number is accepted, and converted
+						if (parameter.numberType == OBS_DATA_NUM_INT) {
+							*(long long*)value = data
+								? obs_data_item_get_int(dataItem)
+								: _view.intAt(viewIndex);
+						} else {
+							*(double*)value = data
+								? obs_data_item_get_double(dataItem)
+								: _view.doubleAt(viewIndex);
+						}
+						break;
+					case OBS_DATA_BOOLEAN:
+						*(bool*)value = data
+							? obs_data_item_get_bool(dataItem)
+							: _view.boolAt(viewIndex);
+						break;
+					case OBS_DATA_OBJECT: {
+						// data keeps its own reference for as long as the request
+						obs_data_t* object = obs_data_item_get_obj(dataItem);
+						*(obs_data_t**)value = object;
+						obs_data_release(object);
+						break;
+					}
+					case OBS_DATA_ARRAY: {
+						obs_data_array_t* array = obs_data_item_get_array(dataItem);
+						*(obs_data_array_t**)value = array;
+						obs_data_array_release(array);
+						break;
+					}
+					default:
+						break;
+				}
+			}
+
+			if (parameter.optional) {
+				*(bool*)(base + parameter.presentOffset) = readable;
+			}
+		}
+
+		if (data) {
+			obs_data_item_next(&dataItem);
+		} else {
+			viewIndex++;
+		}
+	}
+
+	uint64_t required = 0;
+	for (size_t i = 0; i < schema.count; i++) {
+		if (!schema.parameters[i].optional) {
+			required |= 1ULL << i;
+		}
+	}
+
+	if (((present | mistyped) & required) != required) {
+		return "missing request parameters";
+	}
+	if (mistyped & required) {
+		return "invalid request parameters";
+	}
+	return nullptr;
+}
@@ -29,28 +29,56 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include <obs-frontend-api.h>
 
 #include "ConnectionProperties.h"
+#include "RequestView.h"
+#include "RequestParameters.generated.h"
 
 #include "obs-websocket.h"
 
+// Fields of a response, without its message-id and status (nullptr if there
+// are none). Owned by the caller.
 typedef obs_data_t* HandlerResponse;
 
 class WSRequestHandler : public QObject {
 	Q_OBJECT
 
+	// Times processRequest() stage by stage, see tools/bench
+	friend class RequestDispatchBenchmark;
+
 	public:
 		explicit WSRequestHandler(ConnectionProperties& connProperties);
 		~WSRequestHandler();
-		std::string processIncomingMessage(std::string& textMessage);
+		// receivedAt: os_gettime_ns() when the message came in, to measure how
+		// long it waited for a worker (0 if it didn't wait)
+		std::string processIncomingMessage(std::string& textMessage, uint64_t receivedAt = 0);
 
-		bool hasField(QString fieldName, obs_data_type expectedFieldType = OBS_DATA_NULL,
+		bool hasField(const char* fieldName, obs_data_type expectedFieldType = OBS_DATA_NULL,
 					  obs_data_number_type expectedNumberType = OBS_DATA_NUM_INVALID);
-		bool hasBool(QString fieldName);
-		bool hasString(QString fieldName);
-		bool hasNumber(QString fieldName, obs_data_number_type expectedNumberType = OBS_DATA_NUM_INVALID);
-		bool hasInteger(QString fieldName);
-		bool hasDouble(QString fieldName);
-		bool hasArray(QString fieldName);
-		bool hasObject(QString fieldName);
+		bool hasBool(const char* fieldName);
+		bool hasString(const char* fieldName);
+		bool hasNumber(const char* fieldName, obs_data_number_type expectedNumberType = OBS_DATA_NUM_INVALID);
+		bool hasInteger(const char* fieldName);
+		bool hasDouble(const char* fieldName);
+		bool hasArray(const char* fieldName);
+		bool hasObject(const char* fieldName);
+
+		// Read from the in-place view of the payload for handlers flagged
+		// InPlaceParameters, from data otherwise
+		const char* getString(const char* fieldName);
+		bool getBool(const char* fieldName);
+		long long getInt(const char* fieldName);
+		double getDouble(const char* fieldName);
+
+		// Validates and reads all the documented parameters of the request at
+		// once into params, a struct from RequestParameters.generated.h.
+		// Returns nullptr, or the error message for the response: a missing
+		// required parameter, or one of another type. Optional parameters of
+		// another type are left out. Objects and arrays are only available to
+		// handlers that aren't flagged InPlaceParameters.
+		template <typename T>
+		const char* readParameters(T& params) {
+			return readParameters(requestSchema(&params), &params);
+		}
+		const char* readParameters(const RequestSchema& schema, void* params);
 
 		HandlerResponse SendOKResponse(obs_data_t* additionalFields = nullptr);
 		HandlerResponse SendErrorResponse(QString errorMessage);
@@ -61,22 +89,66 @@ class WSRequestHandler : public QObject {
 			return this->data;
 		}
 
+		// Counters and latency histograms of the requests handled so far, by
+		// request type (only types that were requested), and of the ones that
+		// didn't name a known request type
+		static obs_data_t* GetRequestTypeStats();
+		static obs_data_t* GetInvalidRequestStats();
+		static void ResetRequestStats();
+
 	private:
 		const char* _messageId;
 		const char* _requestType;
+		const char* _responseStatus;
 		ConnectionProperties& _connProperties;
 		OBSDataAutoRelease data;
+		RequestView _view;
+		// Set by dispatchRequest(), for the request stats
+		const RequestType* _dispatchedType;
+		uint64_t _handlerStartTime;
 
 		HandlerResponse processRequest(std::string& textMessage);
-
-		static QHash<QString, HandlerResponse(*)(WSRequestHandler*)> messageMap;
-		static QSet<QString> authNotRequired;
+		HandlerResponse dispatchRequest();
+		HandlerResponse runHandler(const RequestType* requestType);
+		void writeResponse(std::string& buffer, obs_data_t* fields);
+		void recordStats(uint64_t receivedAt, uint64_t startTime, uint64_t processedTime);
+		// Complete response as obs_data, for when it's embedded in another one
+		obs_data_t* responseData(obs_data_t* fields);
+
+		typedef HandlerResponse(*RequestHandlerFunc)(WSRequestHandler*);
+		enum RequestFlags {
+			AuthNotRequired = 1,
+			// The handler only reads top-level scalar parameters, through the
+			// get*() accessors: its requests aren't converted to obs_data
+			InPlaceParameters = 2
+		};
+		enum ThreadAffinity {
+			AnyThread,
+			UIThread,
+			GraphicsThread
+		};
+		struct RequestType {
+			const char* name;
+			RequestHandlerFunc handler;
+			int flags;
+			ThreadAffinity affinity;
+		};
+
+		// Generated from WSRequestHandler_List.h, read-only at runtime
+		static const RequestType requestTypes[];
+		static const size_t requestTypeCount;
+		static const RequestType* findRequestType(const char* name);
+		static const RequestType* findRequestType(const char* name, size_t length);
 
 		static HandlerResponse HandleGetVersion(WSRequestHandler* req);
 		static HandlerResponse HandleGetAuthRequired(WSRequestHandler* req);
 		static HandlerResponse HandleAuthenticate(WSRequestHandler* req);
+		static HandlerResponse HandleGetSessionToken(WSRequestHandler* req);
+		static HandlerResponse HandleResumeSession(WSRequestHandler* req);
 
 		static HandlerResponse HandleGetStats(WSRequestHandler* req);
+		static HandlerResponse HandleGetServerStats(WSRequestHandler* req);
+		static HandlerResponse HandleResetRequestStats(WSRequestHandler* req);
 		static HandlerResponse HandleSetHeartbeat(WSRequestHandler* req);
 		static HandlerResponse HandleGetVideoInfo(WSRequestHandler* req);
 
@@ -84,6 +156,7 @@ class WSRequestHandler : public QObject {
 		static HandlerResponse HandleGetFilenameFormatting(WSRequestHandler* req);
 
 		static HandlerResponse HandleBroadcastCustomMessage(WSRequestHandler* req);
+		static HandlerResponse HandleExecuteBatch(WSRequestHandler* req);
 
 		static HandlerResponse HandleSetCurrentScene(WSRequestHandler* req);
 		static HandlerResponse HandleGetCurrentScene(WSRequestHandler* req);
@@ -1,5 +1,12 @@
+#include <string.h>
+
+#include <util/platform.h>
+
 #include "obs-websocket.h"
 #include "Config.h"
+#include "RateLimiter.h"
+#include "RequestArena.h"
+#include "UIThreadExecutor.h"
 #include "Utils.h"
 #include "WSEvents.h"
 
@@ -69,7 +76,10 @@ const char *describe_scale_type(int scale) {
 HandlerResponse WSRequestHandler::HandleGetVersion(WSRequestHandler* req) {
 	QString obsVersion = Utils::OBSVersionString();
 
-	QList<QString> names = req->messageMap.keys();
+	QList<QString> names;
+	for (size_t i = 0; i < requestTypeCount; i++) {
+		names.append(requestTypes[i].name);
+	}
 	names.sort(Qt::CaseInsensitive);
 
 	// (Palakis) OBS' data arrays only support object arrays, so I improvised.
@@ -150,6 +160,82 @@ HandlerResponse WSRequestHandler::HandleAuthenticate(WSRequestHandler* req) {
 	return req->SendOKResponse();
 }
 
+/**
+ * Get a token identifying this client's session, to resume it with `ResumeSession` after reconnecting.
+ * Every event carries an `update-seq` field: clients wanting to resume their session should keep track of the last one received.
+ * Tokens expire one hour after being issued, and as soon as the password or the authentication requirement changes: long-lived clients should get a new one periodically.
+ *
+ * @return {String} `session-token` Session token.
+ * @return {int} `update-seq` Sequence number of the last event sent by the server.
+ *
+ * @api requests
+ * @name GetSessionToken
+ * @category general
+ * @since 4.8.0
+ */
+HandlerResponse WSRequestHandler::HandleGetSessionToken(WSRequestHandler* req) {
+	EventReplayBuffer& replayBuffer = GetEventsSystem()->replayBuffer();
+	QString token = replayBuffer.createSession(req->_connProperties.isAuthenticated());
+	if (token.isEmpty()) {
+		return req->SendErrorResponse("session token generation failed");
+	}
+
+	OBSDataAutoRelease response = obs_data_create();
+	obs_data_set_string(response, "session-token", token.toUtf8());
+	obs_data_set_int(response, "update-seq", replayBuffer.lastSequence());
+	return req->SendOKResponse(response);
+}
+
+/**
+ * Resume a session after reconnecting: restores the authentication state of the session and returns the events missed since `last-update-seq`.
+ * Events broadcast while this request is processed may also be received separately: events with an `update-seq` lower than or equal to the one returned here must be ignored.
+ * If too many events were missed, `resync-required` is true and the client must fetch the state it needs again.
+ *
+ * @param {String} `session-token` Token returned by `GetSessionToken`, less than one hour ago.
+ * @param {int} `last-update-seq` Sequence number of the last event received.
+ *
+ * @return {boolean} `resync-required` Whether the missed events are no longer available.
+ * @return {int} `update-seq` Sequence number of the last event sent by the server.
+ * @return {Array<Object>} `updates` Missed events, in order. Empty if `resync-required` is true.
+ *
+ * @api requests
+ * @name ResumeSession
+ * @category general
+ * @since 4.8.0
+ */
+HandlerResponse WSRequestHandler::HandleResumeSession(WSRequestHandler* req) {
+	if (!req->hasField("session-token") || !req->hasField("last-update-seq")) {
+		return req->SendErrorResponse("missing request parameters");
+	}
+
+	QString token = obs_data_get_string(req->data, "session-token");
+	uint64_t lastSequence = obs_data_get_int(req->data, "last-update-seq");
+
+	EventReplayBuffer& replayBuffer = GetEventsSystem()->replayBuffer();
+
+	bool authenticated = false;
+	if (!replayBuffer.findSession(token, authenticated)) {
+		return req->SendErrorResponse("invalid session token");
+	}
+
+	if (GetConfig()->AuthRequired && !authenticated) {
+		return req->SendErrorResponse("Not Authenticated");
+	}
+	if (authenticated) {
+		req->_connProperties.setAuthenticated(true);
+	}
+
+	OBSDataArrayAutoRelease updates = obs_data_array_create();
+	uint64_t currentSequence = 0;
+	bool resumed = replayBuffer.updatesSince(lastSequence, updates, currentSequence);
+
+	OBSDataAutoRelease response = obs_data_create();
+	obs_data_set_bool(response, "resync-required", !resumed);
+	obs_data_set_int(response, "update-seq", currentSequence);
+	obs_data_set_array(response, "updates", updates);
+	return req->SendOKResponse(response);
+}
+
 /**
  * Enable/disable sending of the Heartbeat event
  *
@@ -231,6 +317,63 @@ HandlerResponse WSRequestHandler::HandleGetStats(WSRequestHandler* req) {
 	return req->SendOKResponse(response);
 }
 
+/**
+ * Get statistics about the websocket server itself: connected clients and the state of their outbound queues.
+ *
+ * @return {int} `connections` Number of connected websocket clients.
+ * @return {int} `local-connections` Number of clients connected to the local socket (see `LocalSocketPath` setting).
+ * @return {int} `dropped-messages` Total number of droppable events (volume, transform, stats) skipped for clients above the high-water mark.
+ * @return {int} `evicted-connections` Number of clients disconnected as slow consumers, for exceeding the outbound queue limit or staying above the high-water mark for too long.
+ * @return {int} `reaped-connections` Number of clients disconnected for missing a pong or staying idle (see `PingInterval`, `PongTimeout` and `IdleTimeout` settings).
+ * @return {int} `outbound-high-water-mark` Outbound queue size (in bytes) above which a client is considered slow.
+ * @return {Array<ClientStats>} `clients` Per-client statistics.
+ * @return {Object} `compression` permessage-deflate statistics.
+ * @return {Object} `write-coalescing` Broadcast write coalescing statistics.
+ * @return {int} `write-coalescing.flushes` Number of times queued updates were sent out by the io threads.
+ * @return {int} `write-coalescing.writes` Number of gathered writes issued to WebSocket clients, counted by the transport. A write gathers all the frames queued on the connection when it starts.
+ * @return {int} `write-coalescing.frames` Number of frames (updates, responses, pings and closes) sent in these writes.
+ * @return {double} `write-coalescing.frames-per-write` Average number of frames per write.
+ * @return {Object} `rate-limits` Admission control statistics.
+ * @return {int} `rate-limits.rejected-requests` Total number of requests rejected with a `rate limit exceeded` error.
+ * @return {int} `rate-limits.rejected-read-requests` Rejected `Get*` and `List*` requests.
+ * @return {int} `rate-limits.rejected-write-requests` Rejected requests of all other types.
+ * @return {Object} `request-arena` Statistics of the per-thread arenas holding request data until the response is sent.
+ * @return {int} `request-arena.requests` Number of requests served from the arenas.
+ * @return {double} `request-arena.allocations-per-request` Average number of arena allocations per request.
+ * @return {double} `request-arena.bytes-per-request` Average number of arena bytes used per request.
+ * @return {int} `request-arena.peak-bytes` Largest number of arena bytes used by a single request.
+ * @return {int} `request-arena.block-allocations` Number of blocks the arenas allocated from the heap since startup.
+ * @return {Object} `request-types` Statistics of each request type requested since startup or the last `ResetRequestStats`, keyed by request type. Sub-requests of `ExecuteBatch` are counted under their own type, without a queue wait.
+ * @return {RequestTypeStats} `request-types.*` Statistics of a request type.
+ * @return {RequestTypeStats} `invalid-requests` Statistics of the requests that had no known request type or weren't valid JSON.
+ * @return {Object} `ui-thread` Statistics of the handlers run on the UI thread.
+ * @return {int} `ui-thread.tasks` Number of handlers (or batches run with `main-thread`) that were sent to the UI thread.
+ * @return {int} `ui-thread.invocations` Number of queued invocations that ran them.
+ * @return {double} `ui-thread.tasks-per-invocation` Average number of handlers run per invocation.
+ *
+ * @api requests
+ * @name GetServerStats
+ * @category general
+ * @since 4.8.0
+ */
+HandlerResponse WSRequestHandler::HandleGetServerStats(WSRequestHandler* req) {
+	OBSDataAutoRelease stats = GetServer()->GetStats();
+	return req->SendOKResponse(stats);
+}
+
+/**
+ * Reset the per request type counters and latency histograms reported by `GetServerStats`.
+ *
+ * @api requests
+ * @name ResetRequestStats
+ * @category general
+ * @since 4.8.0
+ */
+HandlerResponse WSRequestHandler::HandleResetRequestStats(WSRequestHandler* req) {
+	ResetRequestStats();
+	return req->SendOKResponse();
+}
+
 /**
  * Broadcast custom message to all connected WebSocket clients
  *
@@ -264,6 +407,94 @@ HandlerResponse WSRequestHandler::HandleBroadcastCustomMessage(WSRequestHandler*
 	return req->SendOKResponse();
 }
 
+/**
+ * Execute several requests in order, in a single message. Each sub-request is
+ * handled exactly as if it had been sent on its own and is charged against the
+ * rate limits individually.
+ *
+ * @param {Array<Object>} `requests` Requests to execute.
+ * @param {String} `requests.*.request-type` Type of the sub-request.
+ * @param {String (optional)} `requests.*.message-id` Identifier of the sub-request, echoed in its result. Defaults to its index in `requests`.
+ * @param {boolean (optional)} `halt-on-failure` Stop at the first sub-request returning an error. Defaults to false.
+ * @param {boolean (optional)} `main-thread` Execute the whole batch on the UI thread in one go, instead of hopping to it for each request that needs it. Defaults to false.
+ *
+ * @return {Array<Object>} `results` One response per executed sub-request, in order. Requests skipped after a failure have no result.
+ *
+ * @api requests
+ * @name ExecuteBatch
+ * @category general
+ * @since 4.8.0
+ */
+HandlerResponse WSRequestHandler::HandleExecuteBatch(WSRequestHandler* req) {
+	if (!req->hasArray("requests")) {
+		return req->SendErrorResponse("missing request parameters");
+	}
+
+	OBSDataArrayAutoRelease requests = obs_data_get_array(req->data, "requests");
+	bool haltOnFailure = obs_data_get_bool(req->data, "halt-on-failure");
+	bool mainThread = obs_data_get_bool(req->data, "main-thread");
+
+	OBSDataArrayAutoRelease results = obs_data_array_create();
+	auto executeRequests = [&]() {
+		// The UI thread has no scope of its own
+		RequestArena::Scope arenaScope;
+
+		size_t count = obs_data_array_count(requests);
+		for (size_t i = 0; i < count; i++) {
+			WSRequestHandler subRequest(req->_connProperties);
+			subRequest.data = obs_data_array_item(requests, i);
+			if (!obs_data_has_user_value(subRequest.data, "message-id")) {
+				obs_data_set_string(subRequest.data, "message-id",
+					QString::number(i).toUtf8().constData());
+			}
+
+			QString requestType = obs_data_get_string(subRequest.data, "request-type");
+			OBSDataAutoRelease fields;
+			uint64_t startTime = 0;
+			uint64_t processedTime = 0;
+			if (requestType == "ExecuteBatch") {
+				subRequest._messageId = obs_data_get_string(subRequest.data, "message-id");
+				fields = subRequest.SendErrorResponse("batches can't be nested");
+			}
+			else if (!RateLimiter::admitBatchedRequest(req->_connProperties,
+				requestType.toStdString()))
+			{
+				subRequest._messageId = obs_data_get_string(subRequest.data, "message-id");
+				fields = subRequest.SendErrorResponse(RATE_LIMIT_ERROR);
+			}
+			else {
+				startTime = os_gettime_ns();
+				fields = subRequest.dispatchRequest();
+				processedTime = os_gettime_ns();
+			}
+
+			OBSDataAutoRelease result = subRequest.responseData(fields);
+			obs_data_array_push_back(results, result);
+
+			// Rejected sub-requests aren't counted, like rejected requests
+			if (startTime) {
+				subRequest.recordStats(0, startTime, processedTime);
+			}
+
+			if (haltOnFailure && strcmp(subRequest._responseStatus, "error") == 0) {
+				break;
+			}
+		}
+	};
+
+	if (mainThread) {
+		if (!UIThreadExecutor::run(executeRequests)) {
+			return req->SendErrorResponse("OBS is shutting down");
+		}
+	} else {
+		executeRequests();
+	}
+
+	OBSDataAutoRelease response = obs_data_create();
+	obs_data_set_array(response, "results", results);
+	return req->SendOKResponse(response);
+}
+
 
 /**
  * Get basic OBS video information
@@ -0,0 +1,147 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+// List of request types, expanded by WSRequestHandler.cpp with
+// REQUEST_TYPE(name, handler, flags, affinity) defined. affinity is the
+// ThreadAffinity the handler must run with. Intentionally no include guard.
+
+REQUEST_TYPE(GetVersion, HandleGetVersion, AuthNotRequired | InPlaceParameters, AnyThread)
+REQUEST_TYPE(GetAuthRequired, HandleGetAuthRequired, AuthNotRequired | InPlaceParameters, AnyThread)
+REQUEST_TYPE(Authenticate, HandleAuthenticate, AuthNotRequired, AnyThread)
+REQUEST_TYPE(GetSessionToken, HandleGetSessionToken, 0, AnyThread)
+REQUEST_TYPE(ResumeSession, HandleResumeSession, AuthNotRequired, AnyThread)
+
+REQUEST_TYPE(GetStats, HandleGetStats, 0, UIThread)
+REQUEST_TYPE(GetServerStats, HandleGetServerStats, 0, AnyThread)
+REQUEST_TYPE(ResetRequestStats, HandleResetRequestStats, InPlaceParameters, AnyThread)
+REQUEST_TYPE(SetHeartbeat, HandleSetHeartbeat, 0, AnyThread)
+REQUEST_TYPE(GetVideoInfo, HandleGetVideoInfo, 0, AnyThread)
+
+REQUEST_TYPE(SetFilenameFormatting, HandleSetFilenameFormatting, 0, UIThread)
+REQUEST_TYPE(GetFilenameFormatting, HandleGetFilenameFormatting, 0, UIThread)
+
+REQUEST_TYPE(BroadcastCustomMessage, HandleBroadcastCustomMessage, 0, AnyThread)
+REQUEST_TYPE(ExecuteBatch, HandleExecuteBatch, 0, AnyThread)
+
+REQUEST_TYPE(SetCurrentScene, HandleSetCurrentScene, InPlaceParameters, UIThread)
+REQUEST_TYPE(GetCurrentScene, HandleGetCurrentScene, InPlaceParameters, UIThread)
+REQUEST_TYPE(GetSceneList, HandleGetSceneList, InPlaceParameters, UIThread)
+
+REQUEST_TYPE(SetSourceRender, HandleSetSceneItemRender, InPlaceParameters, UIThread) // Retrocompat
+REQUEST_TYPE(SetSceneItemRender, HandleSetSceneItemRender, InPlaceParameters, UIThread)
+REQUEST_TYPE(SetSceneItemPosition, HandleSetSceneItemPosition, 0, UIThread)
+REQUEST_TYPE(SetSceneItemTransform, HandleSetSceneItemTransform, 0, UIThread)
+REQUEST_TYPE(SetSceneItemCrop, HandleSetSceneItemCrop, 0, UIThread)
+REQUEST_TYPE(GetSceneItemProperties, HandleGetSceneItemProperties, 0, UIThread)
+REQUEST_TYPE(SetSceneItemProperties, HandleSetSceneItemProperties, 0, UIThread)
+REQUEST_TYPE(ResetSceneItem, HandleResetSceneItem, 0, UIThread)
+REQUEST_TYPE(DeleteSceneItem, HandleDeleteSceneItem, 0, UIThread)
+REQUEST_TYPE(DuplicateSceneItem, HandleDuplicateSceneItem, 0, UIThread)
+REQUEST_TYPE(ReorderSceneItems, HandleReorderSceneItems, 0, UIThread)
+
+REQUEST_TYPE(GetStreamingStatus, HandleGetStreamingStatus, InPlaceParameters, UIThread)
+REQUEST_TYPE(StartStopStreaming, HandleStartStopStreaming, 0, UIThread)
+REQUEST_TYPE(StartStopRecording, HandleStartStopRecording, 0, UIThread)
+
+REQUEST_TYPE(StartStreaming, HandleStartStreaming, 0, UIThread)
+REQUEST_TYPE(StopStreaming, HandleStopStreaming, 0, UIThread)
+
+REQUEST_TYPE(StartRecording, HandleStartRecording, 0, UIThread)
+REQUEST_TYPE(StopRecording, HandleStopRecording, 0, UIThread)
+REQUEST_TYPE(PauseRecording, HandlePauseRecording, 0, UIThread)
+REQUEST_TYPE(ResumeRecording, HandleResumeRecording, 0, UIThread)
+
+REQUEST_TYPE(StartStopReplayBuffer, HandleStartStopReplayBuffer, 0, UIThread)
+REQUEST_TYPE(StartReplayBuffer, HandleStartReplayBuffer, 0, UIThread)
+REQUEST_TYPE(StopReplayBuffer, HandleStopReplayBuffer, 0, UIThread)
+REQUEST_TYPE(SaveReplayBuffer, HandleSaveReplayBuffer, 0, UIThread)
+
+REQUEST_TYPE(SetRecordingFolder, HandleSetRecordingFolder, 0, UIThread)
+REQUEST_TYPE(GetRecordingFolder, HandleGetRecordingFolder, 0, UIThread)
+
+REQUEST_TYPE(GetTransitionList, HandleGetTransitionList, 0, UIThread)
+REQUEST_TYPE(GetCurrentTransition, HandleGetCurrentTransition, 0, UIThread)
+REQUEST_TYPE(SetCurrentTransition, HandleSetCurrentTransition, 0, UIThread)
+REQUEST_TYPE(SetTransitionDuration, HandleSetTransitionDuration, 0, UIThread)
+REQUEST_TYPE(GetTransitionDuration, HandleGetTransitionDuration, 0, UIThread)
+
+REQUEST_TYPE(SetVolume, HandleSetVolume, InPlaceParameters, AnyThread)
+REQUEST_TYPE(GetVolume, HandleGetVolume, InPlaceParameters, AnyThread)
+REQUEST_TYPE(ToggleMute, HandleToggleMute, InPlaceParameters, AnyThread)
+REQUEST_TYPE(SetMute, HandleSetMute, InPlaceParameters, AnyThread)
+REQUEST_TYPE(GetMute, HandleGetMute, InPlaceParameters, AnyThread)
+REQUEST_TYPE(SetSyncOffset, HandleSetSyncOffset, 0, AnyThread)
+REQUEST_TYPE(GetSyncOffset, HandleGetSyncOffset, 0, AnyThread)
+REQUEST_TYPE(GetSpecialSources, HandleGetSpecialSources, 0, AnyThread)
+REQUEST_TYPE(GetSourcesList, HandleGetSourcesList, 0, AnyThread)
+REQUEST_TYPE(GetSourceTypesList, HandleGetSourceTypesList, 0, AnyThread)
+REQUEST_TYPE(GetSourceSettings, HandleGetSourceSettings, 0, AnyThread)
+REQUEST_TYPE(SetSourceSettings, HandleSetSourceSettings, 0, AnyThread)
+REQUEST_TYPE(TakeSourceScreenshot, HandleTakeSourceScreenshot, 0, GraphicsThread)
+
+REQUEST_TYPE(GetSourceFilters, HandleGetSourceFilters, 0, AnyThread)
+REQUEST_TYPE(AddFilterToSource, HandleAddFilterToSource, 0, AnyThread)
+REQUEST_TYPE(RemoveFilterFromSource, HandleRemoveFilterFromSource, 0, AnyThread)
+REQUEST_TYPE(ReorderSourceFilter, HandleReorderSourceFilter, 0, AnyThread)
+REQUEST_TYPE(MoveSourceFilter, HandleMoveSourceFilter, 0, AnyThread)
+REQUEST_TYPE(SetSourceFilterSettings, HandleSetSourceFilterSettings, 0, AnyThread)
+
+REQUEST_TYPE(SetCurrentSceneCollection, HandleSetCurrentSceneCollection, 0, UIThread)
+REQUEST_TYPE(GetCurrentSceneCollection, HandleGetCurrentSceneCollection, 0, UIThread)
+REQUEST_TYPE(ListSceneCollections, HandleListSceneCollections, 0, UIThread)
+
+REQUEST_TYPE(SetCurrentProfile, HandleSetCurrentProfile, 0, UIThread)
+REQUEST_TYPE(GetCurrentProfile, HandleGetCurrentProfile, 0, UIThread)
+REQUEST_TYPE(ListProfiles, HandleListProfiles, 0, UIThread)
+
+REQUEST_TYPE(SetStreamSettings, HandleSetStreamSettings, 0, UIThread)
+REQUEST_TYPE(GetStreamSettings, HandleGetStreamSettings, 0, UIThread)
+REQUEST_TYPE(SaveStreamSettings, HandleSaveStreamSettings, 0, UIThread)
+#if BUILD_CAPTIONS
+REQUEST_TYPE(SendCaptions, HandleSendCaptions, 0, UIThread)
+#endif
+
+REQUEST_TYPE(GetStudioModeStatus, HandleGetStudioModeStatus, 0, UIThread)
+REQUEST_TYPE(GetPreviewScene, HandleGetPreviewScene, 0, UIThread)
+REQUEST_TYPE(SetPreviewScene, HandleSetPreviewScene, 0, UIThread)
+REQUEST_TYPE(TransitionToProgram, HandleTransitionToProgram, 0, UIThread)
+REQUEST_TYPE(EnableStudioMode, HandleEnableStudioMode, 0, UIThread)
+REQUEST_TYPE(DisableStudioMode, HandleDisableStudioMode, 0, UIThread)
+REQUEST_TYPE(ToggleStudioMode, HandleToggleStudioMode, 0, UIThread)
+
+REQUEST_TYPE(SetTextGDIPlusProperties, HandleSetTextGDIPlusProperties, 0, AnyThread)
+REQUEST_TYPE(GetTextGDIPlusProperties, HandleGetTextGDIPlusProperties, 0, AnyThread)
+
+REQUEST_TYPE(SetTextFreetype2Properties, HandleSetTextFreetype2Properties, 0, AnyThread)
+REQUEST_TYPE(GetTextFreetype2Properties, HandleGetTextFreetype2Properties, 0, AnyThread)
+
+REQUEST_TYPE(GetBrowserSourceProperties, HandleGetBrowserSourceProperties, 0, AnyThread)
+REQUEST_TYPE(SetBrowserSourceProperties, HandleSetBrowserSourceProperties, 0, AnyThread)
+
+REQUEST_TYPE(ListOutputs, HandleListOutputs, 0, AnyThread)
+REQUEST_TYPE(GetOutputInfo, HandleGetOutputInfo, 0, AnyThread)
+REQUEST_TYPE(StartOutput, HandleStartOutput, 0, AnyThread)
+REQUEST_TYPE(StopOutput, HandleStopOutput, 0, AnyThread)
+
+REQUEST_TYPE(GetSourceTypeDefaults, HandleGetSourceTypeDefaults, 0, AnyThread)
+REQUEST_TYPE(AddNewSourceToScene, HandleAddNewSourceToScene, 0, AnyThread)
+REQUEST_TYPE(RemoveSourceFromScene, HandleRemoveSourceFromScene, 0, AnyThread)
+
+REQUEST_TYPE(SetSceneItemOrder, HandleSetSceneItemOrder, 0, AnyThread)
+REQUEST_TYPE(GetScene, HandleGetScene, 0, AnyThread)
+REQUEST_TYPE(SetSceneItemIndex, HandleSetSceneItemIndex, 0, AnyThread)
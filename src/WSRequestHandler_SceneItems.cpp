@@ -314,21 +314,15 @@ HandlerResponse WSRequestHandler::HandleResetSceneItem(WSRequestHandler* req) {
 * @deprecated Since 4.3.0. Prefer the use of SetSceneItemProperties.
 */
 HandlerResponse WSRequestHandler::HandleSetSceneItemRender(WSRequestHandler* req) {
-	if (!req->hasField("source") ||
-		!req->hasField("render"))
-	{
-		return req->SendErrorResponse("missing request parameters");
+	SetSceneItemRenderParameters params;
+	if (const char* error = req->readParameters(params)) {
+		return req->SendErrorResponse(error);
 	}
 
-	const char* itemName = obs_data_get_string(req->data, "source");
-	bool isVisible = obs_data_get_bool(req->data, "render");
-
-	if (!itemName) {
-		return req->SendErrorResponse("invalid request parameters");
-	}
+	const char* itemName = params.source;
+	bool isVisible = params.render;
 
-	const char* sceneName = obs_data_get_string(req->data, "scene-name");
-	OBSScene scene = Utils::GetSceneFromNameOrCurrent(sceneName);
+	OBSScene scene = Utils::GetSceneFromNameOrCurrent(params.sceneName);
 	if (!scene) {
 		return req->SendErrorResponse("requested scene doesn't exist");
 	}
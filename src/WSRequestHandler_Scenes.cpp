@@ -19,12 +19,12 @@
  * @since 0.3
  */
 HandlerResponse WSRequestHandler::HandleSetCurrentScene(WSRequestHandler* req) {
-	if (!req->hasField("scene-name")) {
-		return req->SendErrorResponse("missing request parameters");
+	SetCurrentSceneParameters params;
+	if (const char* error = req->readParameters(params)) {
+		return req->SendErrorResponse(error);
 	}
 
-	const char* sceneName = obs_data_get_string(req->data, "scene-name");
-	OBSSourceAutoRelease source = obs_get_source_by_name(sceneName);
+	OBSSourceAutoRelease source = obs_get_source_by_name(params.sceneName);
 
 	if (source) {
 		obs_frontend_set_current_scene(source);
@@ -161,11 +161,12 @@ HandlerResponse WSRequestHandler::HandleGetSourceTypesList(WSRequestHandler* req
 */
 HandlerResponse WSRequestHandler::HandleGetVolume(WSRequestHandler* req)
 {
-	if (!req->hasField("source")) {
-		return req->SendErrorResponse("missing request parameters");
+	GetVolumeParameters params;
+	if (const char* error = req->readParameters(params)) {
+		return req->SendErrorResponse(error);
 	}
 
-	QString sourceName = obs_data_get_string(req->data, "source");
+	QString sourceName = params.source;
 	if (sourceName.isEmpty()) {
 		return req->SendErrorResponse("invalid request parameters");
 	}
@@ -196,12 +197,13 @@ HandlerResponse WSRequestHandler::HandleGetVolume(WSRequestHandler* req)
  */
 HandlerResponse WSRequestHandler::HandleSetVolume(WSRequestHandler* req)
  {
-	if (!req->hasField("source") || !req->hasField("volume")) {
-		return req->SendErrorResponse("missing request parameters");
+	SetVolumeParameters params;
+	if (const char* error = req->readParameters(params)) {
+		return req->SendErrorResponse(error);
 	}
 
-	QString sourceName = obs_data_get_string(req->data, "source");
-	float sourceVolume = obs_data_get_double(req->data, "volume");
+	QString sourceName = params.source;
+	float sourceVolume = params.volume;
 
 	if (sourceName.isEmpty() || sourceVolume < 0.0 || sourceVolume > 1.0) {
 		return req->SendErrorResponse("invalid request parameters");
@@ -231,11 +233,12 @@ HandlerResponse WSRequestHandler::HandleSetVolume(WSRequestHandler* req)
 */
 HandlerResponse WSRequestHandler::HandleGetMute(WSRequestHandler* req)
 {
-	if (!req->hasField("source")) {
-		return req->SendErrorResponse("missing request parameters");
+	GetMuteParameters params;
+	if (const char* error = req->readParameters(params)) {
+		return req->SendErrorResponse(error);
 	}
 
-	QString sourceName = obs_data_get_string(req->data, "source");
+	QString sourceName = params.source;
 	if (sourceName.isEmpty()) {
 		return req->SendErrorResponse("invalid request parameters");
 	}
@@ -265,12 +268,13 @@ HandlerResponse WSRequestHandler::HandleGetMute(WSRequestHandler* req)
  */
 HandlerResponse WSRequestHandler::HandleSetMute(WSRequestHandler* req)
 {
-	if (!req->hasField("source") || !req->hasField("mute")) {
-		return req->SendErrorResponse("missing request parameters");
+	SetMuteParameters params;
+	if (const char* error = req->readParameters(params)) {
+		return req->SendErrorResponse(error);
 	}
 
-	QString sourceName = obs_data_get_string(req->data, "source");
-	bool mute = obs_data_get_bool(req->data, "mute");
+	QString sourceName = params.source;
+	bool mute = params.mute;
 
 	if (sourceName.isEmpty()) {
 		return req->SendErrorResponse("invalid request parameters");
@@ -297,11 +301,12 @@ HandlerResponse WSRequestHandler::HandleSetMute(WSRequestHandler* req)
 */
 HandlerResponse WSRequestHandler::HandleToggleMute(WSRequestHandler* req)
 {
-	if (!req->hasField("source")) {
-		return req->SendErrorResponse("missing request parameters");
+	ToggleMuteParameters params;
+	if (const char* error = req->readParameters(params)) {
+		return req->SendErrorResponse(error);
 	}
 
-	QString sourceName = obs_data_get_string(req->data, "source");
+	QString sourceName = params.source;
 	if (sourceName.isEmpty()) {
 		return req->SendErrorResponse("invalid request parameters");
 	}
@@ -328,12 +333,13 @@ HandlerResponse WSRequestHandler::HandleToggleMute(WSRequestHandler* req)
  */
 HandlerResponse WSRequestHandler::HandleSetSyncOffset(WSRequestHandler* req)
 {
-	if (!req->hasField("source") || !req->hasField("offset")) {
-		return req->SendErrorResponse("missing request parameters");
+	SetSyncOffsetParameters params;
+	if (const char* error = req->readParameters(params)) {
+		return req->SendErrorResponse(error);
 	}
 
-	QString sourceName = obs_data_get_string(req->data, "source");
-	int64_t sourceSyncOffset = (int64_t)obs_data_get_int(req->data, "offset");
+	QString sourceName = params.source;
+	int64_t sourceSyncOffset = (int64_t)params.offset;
 
 	if (sourceName.isEmpty() || sourceSyncOffset < 0) {
 		return req->SendErrorResponse("invalid request parameters");
@@ -363,11 +369,12 @@ HandlerResponse WSRequestHandler::HandleSetSyncOffset(WSRequestHandler* req)
  */
 HandlerResponse WSRequestHandler::HandleGetSyncOffset(WSRequestHandler* req)
 {
-	if (!req->hasField("source")) {
-		return req->SendErrorResponse("missing request parameters");
+	GetSyncOffsetParameters params;
+	if (const char* error = req->readParameters(params)) {
+		return req->SendErrorResponse(error);
 	}
 
-	QString sourceName = obs_data_get_string(req->data, "source");
+	QString sourceName = params.source;
 	if (sourceName.isEmpty()) {
 		return req->SendErrorResponse("invalid request parameters");
 	}
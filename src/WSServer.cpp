@@ -16,11 +16,13 @@ You should have received a copy of the GNU General Public License along
 with this program. If not, see <https://www.gnu.org/licenses/>
 */
 
-#include <chrono>
-#include <thread>
+#include <algorithm>
+#include <utility>
+#include <vector>
 
 #include <QtCore/QThread>
 #include <QtCore/QByteArray>
+#include <QtCore/QTimer>
 #include <QtWidgets/QMainWindow>
 #include <QtWidgets/QMessageBox>
 #include <QtConcurrent/QtConcurrent>
@@ -31,6 +33,9 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include "obs-websocket.h"
 #include "Config.h"
 #include "Utils.h"
+#include "RateLimiter.h"
+#include "RequestArena.h"
+#include "UIThreadExecutor.h"
 
 QT_USE_NAMESPACE
 
@@ -38,12 +43,41 @@ using websocketpp::lib::placeholders::_1;
 using websocketpp::lib::placeholders::_2;
 using websocketpp::lib::bind;
 
+// Application close code (4000-4999 range) sent to evicted slow consumers
+#define CLOSE_CODE_SLOW_CONSUMER 4000
+// Application close code sent to clients missing a pong or idle for too long
+#define CLOSE_CODE_TIMEOUT 4001
+
+// Reaper period when pings are disabled, for the idle timeout check alone
+#define REAPER_DEFAULT_INTERVAL 1000
+
+// Time (in ms) clients get to complete the closing handshake after stop()
+// before the io loop is stopped
+#define STOP_TIMEOUT 1000
+
+#if defined(ASIO_HAS_IO_URING) && defined(ASIO_DISABLE_EPOLL)
+#define IO_BACKEND "io_uring"
+#else
+#define IO_BACKEND "reactor"
+#endif
+
 WSServer::WSServer()
 	: QObject(nullptr),
-	  _connections(),
-	  _clMutex(QMutex::Recursive)
+	  _ioThreadCount(1),
+	  _connections(std::make_shared<ConnectionMap>()),
+	  _runningIoThreads(0),
+	  _stopping(false),
+	  _stopGeneration(0),
+	  _stopStartTime(0),
+	  _clMutex(),
+	  _droppedMessages(0),
+	  _evictedConnections(0),
+	  _reapedConnections(0),
+	  _broadcastFlushes(0),
+	  _reaperActive(false)
 {
 	_server.init_asio();
+	_broadcastStrand.reset(new websocketpp::lib::asio::io_service::strand(_server.get_io_service()));
 #ifndef _WIN32
 	_server.set_reuse_addr(true);
 #endif
@@ -51,23 +85,66 @@ WSServer::WSServer()
 	_server.set_open_handler(bind(&WSServer::onOpen, this, ::_1));
 	_server.set_close_handler(bind(&WSServer::onClose, this, ::_1));
 	_server.set_message_handler(bind(&WSServer::onMessage, this, ::_1, ::_2));
+	_server.set_pong_handler(bind(&WSServer::onPong, this, ::_1, ::_2));
+	_server.set_pong_timeout_handler(bind(&WSServer::onPongTimeout, this, ::_1, ::_2));
+
+	PerMessageDeflate::setMaxMessageSize(_server.get_max_message_size());
+
+	_localServer = new WSLocalServer(&_threadPool);
+	_localServer->moveToThread(&_localServerThread);
+	_localServerThread.start();
 }
 
 WSServer::~WSServer()
 {
 	stop();
+
+	_localServerThread.quit();
+	_localServerThread.wait();
+	delete _localServer;
+}
+
+// The last reference may be dropped by a request finishing on _threadPool,
+// or by an io thread, whose pool would then wait for itself in the destructor:
+// the server is always deleted on its own thread (the UI thread). Once the UI
+// event loop is gone (on module unload), a server still referenced by
+// requests in flight is left to the process exit.
+void WSServer::destroy(WSServer* server)
+{
+	if (QThread::currentThread() == server->thread()) {
+		delete server;
+	} else {
+		server->deleteLater();
+	}
 }
 
 void WSServer::start(quint16 port)
 {
-	if (_server.is_listening() && port == _serverPort) {
-		blog(LOG_INFO, "WSServer::start: server already on this port. no restart needed");
+	// Also covers a server left without a listening socket by a failed
+	// rebind, whose connections are still served
+	if (_server.is_listening() || (!isStopped() && !_stopping)) {
+		if (port == _serverPort && _server.is_listening()) {
+			blog(LOG_INFO, "WSServer::start: server already on this port. no restart needed");
+		} else {
+			rebind(port);
+		}
+		updateLocalServer();
 		return;
 	}
 
-	if (_server.is_listening()) {
-		stop();
+	if (!isStopped()) {
+		// The previous stop() is still waiting for closing handshakes: cut
+		// them off. Io threads never wait for the UI thread, so they return
+		// as soon as their current handler does.
+		_server.stop();
+		if (!_ioThreadPool.waitForDone(STOP_TIMEOUT)) {
+			blog(LOG_WARNING, "server start: io threads of the previous run still busy after %d ms",
+				STOP_TIMEOUT);
+			showStartFailedMessage(port);
+			return;
+		}
 	}
+	_stopping = false;
 
 	_server.reset();
 
@@ -79,81 +156,583 @@ void WSServer::start(quint16 port)
 	if (errorCode) {
 		std::string errorCodeMessage = errorCode.message();
 		blog(LOG_INFO, "server: listen failed: %s", errorCodeMessage.c_str());
+		showStartFailedMessage(_serverPort);
+		return;
+	}
+
+	// Applies to connections created from now on
+	_server.set_pong_timeout(GetConfig()->PongTimeout);
+
+	_server.start_accept();
+
+	QMutexLocker reaperLocker(&_reaperMutex);
+	_reaperActive = true;
+	scheduleReaper();
+	reaperLocker.unlock();
+
+	// All io threads run the same endpoint. websocketpp's asio transport wraps
+	// each connection's handlers in its own strand (config::asio enables
+	// multithreading), so frames of a given connection are still processed in order.
+	_ioThreadCount = std::max<int>(1, GetConfig()->ServerIoThreads);
+	_ioThreadPool.setMaxThreadCount(_ioThreadCount);
+	_runningIoThreads = _ioThreadCount;
+	WSServerPtr self = shared_from_this();
+	for (int i = 0; i < _ioThreadCount; i++) {
+		QtConcurrent::run(&_ioThreadPool, [self, i]() {
+			self->runIoThread(i);
+		});
+	}
+
+	blog(LOG_INFO, "server started successfully on port %d (%d io threads, %s backend)",
+		_serverPort, _ioThreadCount, IO_BACKEND);
 
-		obs_frontend_push_ui_translation(obs_module_get_string);
-		QString errorTitle = tr("OBSWebsocket.Server.StartFailed.Title");
-		QString errorMessage = tr("OBSWebsocket.Server.StartFailed.Message").arg(_serverPort);
-		obs_frontend_pop_ui_translation();
+	updateLocalServer();
+}
 
-		QMainWindow* mainWindow = reinterpret_cast<QMainWindow*>(obs_frontend_get_main_window());
-		QMessageBox::warning(mainWindow, errorTitle, errorMessage);
+// Moves the listening socket to another port. Established connections are
+// served by the same io threads and are left untouched.
+void WSServer::rebind(quint16 port)
+{
+	uint64_t startTime = os_gettime_ns();
+
+	websocketpp::lib::error_code errorCode;
+	_server.stop_listening(errorCode);
+	_server.listen(port, errorCode);
+	if (!errorCode) {
+		_server.start_accept(errorCode);
+	}
 
+	if (errorCode) {
+		std::string errorCodeMessage = errorCode.message();
+		blog(LOG_INFO, "server: rebind to port %d failed: %s", port, errorCodeMessage.c_str());
+
+		// Stay reachable on the previous port
+		websocketpp::lib::error_code restoreErrorCode;
+		_server.listen(_serverPort, restoreErrorCode);
+		if (!restoreErrorCode) {
+			_server.start_accept(restoreErrorCode);
+		}
+
+		showStartFailedMessage(port);
 		return;
 	}
 
-	_server.start_accept();
+	quint16 previousPort = _serverPort;
+	_serverPort = port;
 
-	QtConcurrent::run([=]() {
-		blog(LOG_INFO, "io thread started");
-		_server.run();
-		blog(LOG_INFO, "io thread exited");
-	});
+	blog(LOG_INFO, "server moved from port %d to port %d in %.2f ms (%zu connections kept)",
+		previousPort, _serverPort, (os_gettime_ns() - startTime) / 1000000.0,
+		connections()->size());
+}
 
-	blog(LOG_INFO, "server started successfully on port %d", _serverPort);
+// Starts, moves or stops the local socket transport to follow the LocalSocketPath setting
+void WSServer::updateLocalServer()
+{
+	QString localSocketPath = GetConfig()->LocalSocketPath;
+	if (localSocketPath == _localSocketPath) {
+		return;
+	}
+	_localSocketPath = localSocketPath;
+
+	if (localSocketPath.isEmpty()) {
+		QMetaObject::invokeMethod(_localServer, "stop", Qt::BlockingQueuedConnection);
+	} else {
+		QMetaObject::invokeMethod(_localServer, "start", Qt::BlockingQueuedConnection,
+			Q_ARG(QString, localSocketPath));
+	}
 }
 
+void WSServer::showStartFailedMessage(quint16 port)
+{
+	obs_frontend_push_ui_translation(obs_module_get_string);
+	QString errorTitle = tr("OBSWebsocket.Server.StartFailed.Title");
+	QString errorMessage = tr("OBSWebsocket.Server.StartFailed.Message").arg(port);
+	obs_frontend_pop_ui_translation();
+
+	QMainWindow* mainWindow = reinterpret_cast<QMainWindow*>(obs_frontend_get_main_window());
+	QMessageBox::warning(mainWindow, errorTitle, errorMessage);
+}
+
+// Returns without waiting for requests in flight, which may themselves wait
+// for the UI thread (usually the caller), nor for closing handshakes: the
+// last io thread to exit completes the stop (see onIoThreadsExited).
 void WSServer::stop()
 {
-	if (!_server.is_listening()) {
+	// Not only checking for the listening socket: a failed rebind can leave
+	// the server without one, still serving its connections
+	if (isStopped() || _stopping) {
 		return;
 	}
 
-	_server.stop_listening();
-	for (connection_hdl hdl : _connections) {
-		_server.close(hdl, websocketpp::close::status::going_away, "Server stopping");
+	_stopStartTime = os_gettime_ns();
+	uint64_t generation = ++_stopGeneration;
+	_stopping = true;
+
+	QMetaObject::invokeMethod(_localServer, "stop", Qt::BlockingQueuedConnection);
+	_localSocketPath = QString();
+
+	QMutexLocker reaperLocker(&_reaperMutex);
+	_reaperActive = false;
+	if (_reaperTimer) {
+		_reaperTimer->cancel();
+		_reaperTimer.reset();
+	}
+	reaperLocker.unlock();
+
+	websocketpp::lib::error_code stopListeningErrorCode;
+	_server.stop_listening(stopListeningErrorCode);
+	ConnectionSnapshot snapshot = connections();
+	for (auto& connection : *snapshot) {
+		websocketpp::lib::error_code errorCode;
+		_server.close(connection.first, websocketpp::close::status::going_away,
+			"Server stopping", errorCode);
+	}
+
+	QMutexLocker locker(&_clMutex);
+	std::atomic_store(&_connections, ConnectionSnapshot(std::make_shared<ConnectionMap>()));
+	locker.unlock();
+
+	blog(LOG_INFO, "server stop requested in %.2f ms",
+		(os_gettime_ns() - _stopStartTime) / 1000000.0);
+
+	// With the acceptor, the reaper timer and all connections closed, the io
+	// threads run out of work and return on their own. Peers that don't
+	// complete the closing handshake in time are cut off by stopping the io loop.
+	QTimer::singleShot(STOP_TIMEOUT, this, [this, generation]() {
+		if (_stopping && _stopGeneration == generation && !isStopped()) {
+			blog(LOG_WARNING, "server stop: closing handshakes timed out, stopping io threads");
+			_server.stop();
+		}
+	});
+}
+
+// For module unload: the UI event loop is gone, so the handshake timeout
+// armed by stop() would never fire. Waits for the io threads, cutting off
+// closing handshakes that take longer than STOP_TIMEOUT.
+void WSServer::shutdown()
+{
+	stop();
+
+	if (!_ioThreadPool.waitForDone(STOP_TIMEOUT)) {
+		blog(LOG_WARNING, "server shutdown: closing handshakes timed out, stopping io threads");
+		_server.stop();
+		_ioThreadPool.waitForDone();
+
+		// Handlers left in the stopped loop (broadcast flushes) hold a
+		// reference to the server: run them now that no io thread can
+		_server.reset();
+		_server.poll();
 	}
-	_connections.clear();
-	_connectionProperties.clear();
+}
+
+void WSServer::runIoThread(int index)
+{
+	blog(LOG_INFO, "io thread %d started", index);
+	_server.run();
+	blog(LOG_INFO, "io thread %d exited", index);
 
-	_threadPool.waitForDone();
+	if (--_runningIoThreads == 0) {
+		onIoThreadsExited();
+	}
+}
 
-	while (!_server.stopped()) {
-		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+// Runs on the last io thread to exit
+void WSServer::onIoThreadsExited()
+{
+	// Drop updates whose flush was cancelled with the io loop
+	QMutexLocker broadcastLocker(&_broadcastMutex);
+	_pendingBroadcasts.clear();
+	broadcastLocker.unlock();
+
+	if (_stopping) {
+		blog(LOG_INFO, "server stopped successfully in %.2f ms (%d requests still running)",
+			(os_gettime_ns() - _stopStartTime) / 1000000.0,
+			_threadPool.activeThreadCount());
 	}
+}
 
-	blog(LOG_INFO, "server stopped successfully");
+server::message_ptr WSServer::makeTextMessage(std::string payload)
+{
+	// Messages are framed once here and flagged as prepared: websocketpp then
+	// queues this very buffer on every connection instead of re-framing a copy
+	// of the payload for each of them. Server frames are never masked, so the
+	// same header is valid for all clients.
+	server::message_ptr message = websocketpp::lib::make_shared<message_type>(
+		message_type::con_msg_man_ptr(), websocketpp::frame::opcode::text, 0);
+	message->get_raw_payload().swap(payload);
+
+	size_t payloadSize = message->get_payload().size();
+	websocketpp::frame::basic_header header(websocketpp::frame::opcode::text,
+		payloadSize, true, false);
+	websocketpp::frame::extended_header extendedHeader(payloadSize);
+	message->set_header(websocketpp::frame::prepare_header(header, extendedHeader));
+	message->set_prepared(true);
+
+	return message;
 }
 
-void WSServer::broadcast(std::string message)
+server::message_ptr WSServer::makeCompressibleMessage(server::message_ptr message)
 {
-	QMutexLocker locker(&_clMutex);
-	for (connection_hdl hdl : _connections) {
-		if (GetConfig()->AuthRequired) {
-			bool authenticated = _connectionProperties[hdl].isAuthenticated();
-			if (!authenticated) {
-				continue;
-			}
+	// Left unprepared so that websocketpp deflates it with the compression
+	// context of each connection it is sent to
+	server::message_ptr compressible = websocketpp::lib::make_shared<message_type>(
+		message_type::con_msg_man_ptr(), websocketpp::frame::opcode::text, 0);
+	compressible->set_payload(message->get_payload());
+	compressible->set_compressed(true);
+	return compressible;
+}
+
+void WSServer::broadcast(server::message_ptr message, bool droppable)
+{
+	// Updates are queued and sent from the io threads: updates emitted in a
+	// burst (scene collection load, drag operations) are then queued on each
+	// connection back to back, so that the frames waiting behind a write in
+	// progress go out together in the next one (see CountingTransport.h).
+	if (_server.is_listening()) {
+		QMutexLocker locker(&_broadcastMutex);
+		_pendingBroadcasts.emplace_back(message, droppable);
+		bool flushScheduled = (_pendingBroadcasts.size() > 1);
+		locker.unlock();
+
+		if (!flushScheduled) {
+			// Flushes run one at a time, in order: with several io threads,
+			// a flush posted while another one is still sending would
+			// otherwise overtake it on some connections.
+			WSServerPtr self = shared_from_this();
+			_broadcastStrand->post([self]() {
+				self->flushBroadcasts();
+			});
+		}
+	}
+
+	if (_localServer->clientCount() > 0) {
+		_localServer->broadcast(message->get_payload(), droppable);
+	}
+}
+
+void WSServer::flushBroadcasts()
+{
+	std::vector<std::pair<server::message_ptr, bool>> batch;
+	QMutexLocker locker(&_broadcastMutex);
+	batch.swap(_pendingBroadcasts);
+	locker.unlock();
+
+	if (batch.empty()) {
+		return;
+	}
+
+	// Compressible copies are created lazily, once per message for all connections
+	std::vector<server::message_ptr> compressibleMessages(batch.size());
+
+	bool authRequired = GetConfig()->AuthRequired;
+	ConnectionSnapshot snapshot = connections();
+	for (auto& connection : *snapshot) {
+		ConnectionProperties& connProperties = *connection.second;
+		if (authRequired && !connProperties.isAuthenticated()) {
+			continue;
+		}
+
+		for (size_t i = 0; i < batch.size(); i++) {
+			sendMessage(connection.first, connProperties, batch[i].first,
+				compressibleMessages[i], batch[i].second);
+		}
+	}
+
+	_broadcastFlushes++;
+}
+
+bool WSServer::sendMessage(connection_hdl hdl, ConnectionProperties& connProperties,
+	server::message_ptr message, server::message_ptr& compressibleMessage, bool droppable)
+{
+	websocketpp::lib::error_code errorCode;
+	server::connection_ptr conn = _server.get_con_from_hdl(hdl, errorCode);
+	if (errorCode || conn->get_state() != websocketpp::session::state::open) {
+		return false;
+	}
+
+	// Responses and other non-droppable messages are sent however large they
+	// are: only what's already queued counts against the limit for them.
+	size_t pendingBytes = droppable ? message->get_payload().size() : 0;
+	if (evictIfSlow(conn, connProperties, pendingBytes)) {
+		return false;
+	}
+
+	auto config = GetConfig();
+	if (droppable && conn->get_buffered_amount() > config->OutboundHighWaterMark) {
+		connProperties.addDroppedMessage();
+		_droppedMessages++;
+		return false;
+	}
+
+	if (connProperties.isCompressed()
+		&& message->get_payload().size() >= config->CompressionThreshold)
+	{
+		if (!compressibleMessage) {
+			compressibleMessage = makeCompressibleMessage(message);
 		}
+		message = compressibleMessage;
+	}
+
+	errorCode = conn->send(message);
+	if (errorCode) {
+		std::string errorCodeMessage = errorCode.message();
+		blog(LOG_INFO, "server: send failed: %s",
+			errorCodeMessage.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+// Evicts the client if its outbound queue, plus pendingBytes about to be sent,
+// exceeds the queue limit, or if it stayed above the high-water mark for too
+// long. Returns whether the client was evicted.
+bool WSServer::evictIfSlow(server::connection_ptr conn,
+	ConnectionProperties& connProperties, size_t pendingBytes)
+{
+	auto config = GetConfig();
+	size_t bufferedAmount = conn->get_buffered_amount();
+
+	if (bufferedAmount + pendingBytes > config->OutboundQueueLimit) {
+		evictConnection(conn, "outbound queue limit exceeded");
+		return true;
+	}
+
+	if (bufferedAmount <= config->OutboundHighWaterMark) {
+		connProperties.setOverHighWaterSince(0);
+		return false;
+	}
+
+	uint64_t now = os_gettime_ns();
+	uint64_t overSince = connProperties.overHighWaterSince();
+	if (!overSince) {
+		connProperties.setOverHighWaterSince(now);
+	} else if ((now - overSince) > (config->SlowConsumerTimeout * 1000000ULL)) {
+		evictConnection(conn, "outbound queue above high-water mark for too long");
+		return true;
+	}
+
+	return false;
+}
+
+void WSServer::evictConnection(server::connection_ptr conn, const char* reason)
+{
+	std::string remoteEndpoint = conn->get_remote_endpoint();
+	blog(LOG_WARNING, "evicting slow client %s: %s (%zu bytes buffered)",
+		remoteEndpoint.c_str(), reason, conn->get_buffered_amount());
+
+	websocketpp::lib::error_code errorCode;
+	conn->close(CLOSE_CODE_SLOW_CONSUMER, "Slow consumer", errorCode);
+	_evictedConnections++;
+}
+
+// Must be called with _reaperMutex held
+void WSServer::scheduleReaper()
+{
+	uint64_t interval = GetConfig()->PingInterval;
+	if (interval == 0) {
+		interval = REAPER_DEFAULT_INTERVAL;
+	}
 
+	_reaperTimer = _server.set_timer((long)interval,
+		bind(&WSServer::onReaperTimer, this, ::_1));
+}
+
+void WSServer::onReaperTimer(const websocketpp::lib::error_code& errorCode)
+{
+	if (errorCode) {
+		// Cancelled by stop()
+		return;
+	}
+
+	reapConnections();
+
+	QMutexLocker locker(&_reaperMutex);
+	if (_reaperActive) {
+		scheduleReaper();
+	}
+}
+
+// Disconnects clients that sent nothing (not even a pong) for longer than the
+// idle timeout, and pings the others. Clients failing to answer a ping in
+// time are handled by onPongTimeout. Also evicts slow consumers that nothing
+// was sent to since they went above the high-water mark, which the send path
+// alone would never catch.
+void WSServer::reapConnections()
+{
+	auto config = GetConfig();
+	uint64_t now = os_gettime_ns();
+	uint64_t idleTimeout = config->IdleTimeout * 1000000;
+
+	ConnectionSnapshot snapshot = connections();
+	for (auto& connection : *snapshot) {
 		websocketpp::lib::error_code errorCode;
-		_server.send(hdl, message, websocketpp::frame::opcode::text, errorCode);
+		server::connection_ptr conn = _server.get_con_from_hdl(connection.first, errorCode);
+		if (errorCode || conn->get_state() != websocketpp::session::state::open) {
+			continue;
+		}
+
+		uint64_t lastActivity = connection.second->lastActivity();
+		if (idleTimeout && now > lastActivity && (now - lastActivity) > idleTimeout) {
+			reapConnection(conn, "Idle timeout");
+			continue;
+		}
+
+		if (evictIfSlow(conn, *connection.second, 0)) {
+			continue;
+		}
+
+		if (config->PingInterval) {
+			conn->ping("", errorCode);
+		}
+	}
+}
+
+void WSServer::reapConnection(server::connection_ptr conn, const char* reason)
+{
+	std::string remoteEndpoint = conn->get_remote_endpoint();
+	blog(LOG_WARNING, "disconnecting unresponsive client %s: %s",
+		remoteEndpoint.c_str(), reason);
+
+	// Stop broadcasting to it right away: a dead peer won't complete the
+	// closing handshake and onClose only runs once it times out.
+	removeConnection(conn->get_handle());
+
+	websocketpp::lib::error_code errorCode;
+	conn->close(CLOSE_CODE_TIMEOUT, reason, errorCode);
+	_reapedConnections++;
+}
+
+/**
+ * @typedef {Object} `ClientStats`
+ * @property {String} `remote-address` Address and port of the client.
+ * @property {boolean} `authenticated` Whether the client is authenticated.
+ * @property {int} `outbound-queue-bytes` Bytes waiting in the client's outbound queue.
+ * @property {int} `dropped-messages` Number of droppable events skipped because the client was above the high-water mark.
+ * @property {boolean} `compression` Whether permessage-deflate was negotiated with the client.
+ * @property {int} `rejected-requests` Number of the client's requests rejected by rate limiting.
+ */
+/**
+ * @typedef {Object} `RequestTypeStats`
+ * @property {int} `requests` Number of requests handled.
+ * @property {int} `errors` Number of them that got an error response.
+ * @property {LatencyStats} `queue-wait` Time between the request being received and a worker thread starting on it.
+ * @property {LatencyStats} `parse` Time spent parsing and validating the request, up to the handler call.
+ * @property {LatencyStats} `handler` Time spent in the request handler.
+ * @property {LatencyStats} `serialize` Time spent writing the response.
+ */
+/**
+ * @typedef {Object} `LatencyStats`
+ * @property {int} `count` Number of measurements.
+ * @property {double} `mean` Mean duration, in microseconds.
+ * @property {double} `p50` Median duration, in microseconds (within 12.5%, like the other percentiles).
+ * @property {double} `p90` 90th percentile, in microseconds.
+ * @property {double} `p99` 99th percentile, in microseconds.
+ * @property {double} `p999` 99.9th percentile, in microseconds.
+ * @property {double} `max` Longest duration, in microseconds.
+ */
+obs_data_t* WSServer::GetStats()
+{
+	OBSDataArrayAutoRelease clients = obs_data_array_create();
 
+	ConnectionSnapshot snapshot = connections();
+	for (auto& connection : *snapshot) {
+		websocketpp::lib::error_code errorCode;
+		server::connection_ptr conn = _server.get_con_from_hdl(connection.first, errorCode);
 		if (errorCode) {
-			std::string errorCodeMessage = errorCode.message();
-			blog(LOG_INFO, "server(broadcast): send failed: %s",
-				errorCodeMessage.c_str());
+			continue;
 		}
+
+		ConnectionProperties& connProperties = *connection.second;
+
+		OBSDataAutoRelease client = obs_data_create();
+		obs_data_set_string(client, "remote-address", conn->get_remote_endpoint().c_str());
+		obs_data_set_bool(client, "authenticated", connProperties.isAuthenticated());
+		obs_data_set_int(client, "outbound-queue-bytes", conn->get_buffered_amount());
+		obs_data_set_int(client, "dropped-messages", connProperties.droppedMessages());
+		obs_data_set_bool(client, "compression", connProperties.isCompressed());
+		obs_data_set_int(client, "rejected-requests", connProperties.rejectedRequests());
+		obs_data_array_push_back(clients, client);
 	}
+	size_t connectionCount = snapshot->size();
+
+	obs_data_t* stats = obs_data_create();
+	obs_data_set_int(stats, "connections", connectionCount);
+	obs_data_set_int(stats, "local-connections", _localServer->clientCount());
+	obs_data_set_int(stats, "dropped-messages", _droppedMessages.load());
+	obs_data_set_int(stats, "evicted-connections", _evictedConnections.load());
+	obs_data_set_int(stats, "reaped-connections", _reapedConnections.load());
+	obs_data_set_int(stats, "outbound-high-water-mark", GetConfig()->OutboundHighWaterMark);
+	obs_data_set_array(stats, "clients", clients);
+
+	uint64_t writes = transport_connection::writes();
+	uint64_t frames = transport_connection::frames();
+	OBSDataAutoRelease writeCoalescing = obs_data_create();
+	obs_data_set_int(writeCoalescing, "flushes", _broadcastFlushes.load());
+	obs_data_set_int(writeCoalescing, "writes", writes);
+	obs_data_set_int(writeCoalescing, "frames", frames);
+	obs_data_set_double(writeCoalescing, "frames-per-write",
+		writes ? (double)frames / writes : 0.0);
+	obs_data_set_obj(stats, "write-coalescing", writeCoalescing);
+
+	OBSDataAutoRelease rateLimits = obs_data_create();
+	obs_data_set_int(rateLimits, "rejected-requests", RateLimiter::rejectedRequests());
+	obs_data_set_int(rateLimits, "rejected-read-requests", RateLimiter::rejectedReadRequests());
+	obs_data_set_int(rateLimits, "rejected-write-requests", RateLimiter::rejectedWriteRequests());
+	obs_data_set_obj(stats, "rate-limits", rateLimits);
+
+	uint64_t arenaRequests = RequestArena::requests();
+	OBSDataAutoRelease requestArena = obs_data_create();
+	obs_data_set_int(requestArena, "requests", arenaRequests);
+	obs_data_set_double(requestArena, "allocations-per-request",
+		arenaRequests ? (double)RequestArena::allocations() / arenaRequests : 0.0);
+	obs_data_set_double(requestArena, "bytes-per-request",
+		arenaRequests ? (double)RequestArena::allocatedBytes() / arenaRequests : 0.0);
+	obs_data_set_int(requestArena, "peak-bytes", RequestArena::peakBytes());
+	obs_data_set_int(requestArena, "block-allocations", RequestArena::blockAllocations());
+	obs_data_set_obj(stats, "request-arena", requestArena);
+
+	OBSDataAutoRelease requestTypes = WSRequestHandler::GetRequestTypeStats();
+	obs_data_set_obj(stats, "request-types", requestTypes);
+	OBSDataAutoRelease invalidRequests = WSRequestHandler::GetInvalidRequestStats();
+	obs_data_set_obj(stats, "invalid-requests", invalidRequests);
+
+	uint64_t uiThreadTasks = UIThreadExecutor::tasks();
+	uint64_t uiThreadInvocations = UIThreadExecutor::invocations();
+	OBSDataAutoRelease uiThread = obs_data_create();
+	obs_data_set_int(uiThread, "tasks", uiThreadTasks);
+	obs_data_set_int(uiThread, "invocations", uiThreadInvocations);
+	obs_data_set_double(uiThread, "tasks-per-invocation",
+		uiThreadInvocations ? (double)uiThreadTasks / uiThreadInvocations : 0.0);
+	obs_data_set_obj(stats, "ui-thread", uiThread);
+
+	uint64_t uncompressedBytes = PerMessageDeflate::uncompressedBytes();
+	uint64_t compressedBytes = PerMessageDeflate::compressedBytes();
+	OBSDataAutoRelease compression = obs_data_create();
+	obs_data_set_bool(compression, "enabled", GetConfig()->CompressionEnabled);
+	obs_data_set_int(compression, "compressed-messages", PerMessageDeflate::compressedMessages());
+	obs_data_set_int(compression, "uncompressed-bytes", uncompressedBytes);
+	obs_data_set_int(compression, "compressed-bytes", compressedBytes);
+	obs_data_set_int(compression, "bytes-saved",
+		uncompressedBytes > compressedBytes ? uncompressedBytes - compressedBytes : 0);
+	obs_data_set_obj(stats, "compression", compression);
+
+	return stats;
 }
 
 void WSServer::onOpen(connection_hdl hdl)
 {
-	QMutexLocker locker(&_clMutex);
-	_connections.insert(hdl);
-	locker.unlock();
+	auto conn = _server.get_con_from_hdl(hdl);
+	std::string extensions = conn->get_response_header("Sec-WebSocket-Extensions");
+	bool compressed = (extensions.find("permessage-deflate") != std::string::npos);
+
+	ConnectionPropertiesPtr connProperties = std::make_shared<ConnectionProperties>();
+	connProperties->setCompressed(compressed);
+	connProperties->setLastActivity(os_gettime_ns());
+	addConnection(hdl, connProperties);
 
 	QString clientIp = getRemoteEndpoint(hdl);
-	notifyConnection(clientIp);
+	_notifier.notifyConnection(clientIp);
 	blog(LOG_INFO, "new client connection from %s", clientIp.toUtf8().constData());
 }
 
@@ -164,66 +743,126 @@ void WSServer::onMessage(connection_hdl hdl, server::message_ptr message)
 		return;
 	}
 
-	QtConcurrent::run(&_threadPool, [=]() {
-		std::string payload = message->get_payload();
+	ConnectionPropertiesPtr connProperties = connectionProperties(hdl);
+	if (!connProperties) {
+		return;
+	}
+	uint64_t receivedAt = os_gettime_ns();
+	connProperties->setLastActivity(receivedAt);
 
-		QMutexLocker locker(&_clMutex);
-		ConnectionProperties& connProperties = _connectionProperties[hdl];
-		locker.unlock();
+	if (connProperties->requestExecutor()->pendingTasks() >= MAX_QUEUED_TASKS) {
+		websocketpp::lib::error_code errorCode;
+		server::connection_ptr conn = _server.get_con_from_hdl(hdl, errorCode);
+		if (!errorCode) {
+			evictConnection(conn, "request queue limit exceeded");
+		}
+		return;
+	}
 
-		WSRequestHandler handler(connProperties);
-		std::string response = handler.processIncomingMessage(payload);
+	// Keeps the server alive until the request is done, even if it's
+	// stopped and released in the meantime
+	WSServerPtr self = shared_from_this();
+
+	std::string rejectionResponse;
+	if (!RateLimiter::admitRequest(*connProperties, message->get_payload(), rejectionResponse)) {
+		// Goes through the client's executor too, so that it doesn't
+		// overtake the responses to requests queued before it
+		connProperties->requestExecutor()->post(&_threadPool,
+			[self, hdl, connProperties, rejectionResponse]()
+		{
+			server::message_ptr compressibleMessage;
+			self->sendMessage(hdl, *connProperties, makeTextMessage(rejectionResponse),
+				compressibleMessage, false);
+		});
+		return;
+	}
 
-		websocketpp::lib::error_code errorCode;
-		_server.send(hdl, response, websocketpp::frame::opcode::text, errorCode);
+	// Requests of a single client are run in order so that pipelined requests
+	// get their responses in the order they were sent
+	connProperties->requestExecutor()->post(&_threadPool,
+		[self, hdl, connProperties, message, receivedAt]()
+	{
+		std::string payload = message->get_payload();
 
-		if (errorCode) {
-			std::string errorCodeMessage = errorCode.message();
-			blog(LOG_INFO, "server(response): send failed: %s",
-				errorCodeMessage.c_str());
-		}
+		WSRequestHandler handler(*connProperties);
+		std::string response = handler.processIncomingMessage(payload, receivedAt);
+
+		server::message_ptr compressibleMessage;
+		self->sendMessage(hdl, *connProperties, makeTextMessage(std::move(response)),
+			compressibleMessage, false);
 	});
 }
 
 void WSServer::onClose(connection_hdl hdl)
 {
-	QMutexLocker locker(&_clMutex);
-	_connections.erase(hdl);
-	_connectionProperties.erase(hdl);
-	locker.unlock();
+	removeConnection(hdl);
 
 	auto conn = _server.get_con_from_hdl(hdl);
 	auto localCloseCode = conn->get_local_close_code();
 
 	if (localCloseCode != websocketpp::close::status::going_away) {
 		QString clientIp = getRemoteEndpoint(hdl);
-		notifyDisconnection(clientIp);
+		_notifier.notifyDisconnection(clientIp);
 		blog(LOG_INFO, "client %s disconnected", clientIp.toUtf8().constData());
 	}
 }
 
-QString WSServer::getRemoteEndpoint(connection_hdl hdl)
+void WSServer::onPong(connection_hdl hdl, std::string payload)
 {
-	auto conn = _server.get_con_from_hdl(hdl);
-	return QString::fromStdString(conn->get_remote_endpoint());
+	ConnectionPropertiesPtr connProperties = connectionProperties(hdl);
+	if (connProperties) {
+		connProperties->setLastActivity(os_gettime_ns());
+	}
 }
 
-void WSServer::notifyConnection(QString clientIp)
+void WSServer::onPongTimeout(connection_hdl hdl, std::string payload)
 {
-	obs_frontend_push_ui_translation(obs_module_get_string);
-	QString title = tr("OBSWebsocket.NotifyConnect.Title");
-	QString msg = tr("OBSWebsocket.NotifyConnect.Message").arg(clientIp);
-	obs_frontend_pop_ui_translation();
+	websocketpp::lib::error_code errorCode;
+	server::connection_ptr conn = _server.get_con_from_hdl(hdl, errorCode);
+	if (errorCode || conn->get_state() != websocketpp::session::state::open) {
+		return;
+	}
 
-	Utils::SysTrayNotify(msg, QSystemTrayIcon::Information, title);
+	reapConnection(conn, "Ping timeout");
 }
 
-void WSServer::notifyDisconnection(QString clientIp)
+ConnectionSnapshot WSServer::connections()
 {
-	obs_frontend_push_ui_translation(obs_module_get_string);
-	QString title = tr("OBSWebsocket.NotifyDisconnect.Title");
-	QString msg = tr("OBSWebsocket.NotifyDisconnect.Message").arg(clientIp);
-	obs_frontend_pop_ui_translation();
+	return std::atomic_load(&_connections);
+}
 
-	Utils::SysTrayNotify(msg, QSystemTrayIcon::Information, title);
+ConnectionPropertiesPtr WSServer::connectionProperties(connection_hdl hdl)
+{
+	ConnectionSnapshot snapshot = connections();
+	auto it = snapshot->find(hdl);
+	if (it == snapshot->end()) {
+		return nullptr;
+	}
+	return it->second;
+}
+
+void WSServer::addConnection(connection_hdl hdl, ConnectionPropertiesPtr connProperties)
+{
+	QMutexLocker locker(&_clMutex);
+	auto updated = std::make_shared<ConnectionMap>(*_connections);
+	(*updated)[hdl] = connProperties;
+	std::atomic_store(&_connections, ConnectionSnapshot(updated));
+}
+
+void WSServer::removeConnection(connection_hdl hdl)
+{
+	QMutexLocker locker(&_clMutex);
+	if (!_connections->count(hdl)) {
+		return;
+	}
+
+	auto updated = std::make_shared<ConnectionMap>(*_connections);
+	updated->erase(hdl);
+	std::atomic_store(&_connections, ConnectionSnapshot(updated));
+}
+
+QString WSServer::getRemoteEndpoint(connection_hdl hdl)
+{
+	auto conn = _server.get_con_from_hdl(hdl);
+	return QString::fromStdString(conn->get_remote_endpoint());
 }
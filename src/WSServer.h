@@ -18,52 +18,143 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 
 #pragma once
 
+#include <atomic>
 #include <map>
-#include <set>
+#include <memory>
+#include <utility>
+#include <vector>
 #include <QtCore/QObject>
 #include <QtCore/QMutex>
 #include <QtCore/QSharedPointer>
 #include <QtCore/QVariantHash>
 #include <QtCore/QThreadPool>
+#include <QtCore/QThread>
 
 #include <websocketpp/config/asio_no_tls.hpp>
 #include <websocketpp/server.hpp>
 
 #include "ConnectionProperties.h"
+#include "ConnectionNotifier.h"
+#include "CountingTransport.h"
+#include "PerMessageDeflate.h"
+#include "WSLocalServer.h"
 
 #include "WSRequestHandler.h"
 
 using websocketpp::connection_hdl;
 
-typedef websocketpp::server<websocketpp::config::asio> server;
+struct WSServerConfig : public websocketpp::config::asio {
+	typedef WSServerConfig type;
+	typedef websocketpp::config::asio base;
 
-class WSServer : public QObject
+	typedef PerMessageDeflate permessage_deflate_type;
+	typedef CountingEndpoint<base::transport_config> transport_type;
+};
+
+typedef websocketpp::server<WSServerConfig> server;
+typedef WSServerConfig::message_type message_type;
+typedef CountingConnection<WSServerConfig::transport_config> transport_connection;
+
+typedef std::shared_ptr<ConnectionProperties> ConnectionPropertiesPtr;
+typedef std::map<connection_hdl, ConnectionPropertiesPtr,
+	std::owner_less<connection_hdl>> ConnectionMap;
+typedef std::shared_ptr<const ConnectionMap> ConnectionSnapshot;
+
+// Owned through WSServerPtr, created with WSServer::destroy as its deleter:
+// requests in flight and io threads hold a reference, so the server outlives
+// them even when stop() returns before they're done.
+class WSServer : public QObject, public std::enable_shared_from_this<WSServer>
 {
 Q_OBJECT
 
 public:
 	explicit WSServer();
 	virtual ~WSServer();
+	static void destroy(WSServer* server);
 	void start(quint16 port);
 	void stop();
-	void broadcast(std::string message);
+	void shutdown();
+	// True once the io threads of the last stop() have exited
+	bool isStopped() const {
+		return _runningIoThreads.load() == 0;
+	}
+	void broadcast(server::message_ptr message, bool droppable = false);
+	static server::message_ptr makeTextMessage(std::string payload);
+	obs_data_t* GetStats();
 	QThreadPool* threadPool() {
 		return &_threadPool;
 	}
 
 private:
+	void rebind(quint16 port);
+	void runIoThread(int index);
+	void onIoThreadsExited();
+	void updateLocalServer();
+	void showStartFailedMessage(quint16 port);
+
 	void onOpen(connection_hdl hdl);
 	void onMessage(connection_hdl hdl, server::message_ptr message);
 	void onClose(connection_hdl hdl);
+	void onPong(connection_hdl hdl, std::string payload);
+	void onPongTimeout(connection_hdl hdl, std::string payload);
+	void onReaperTimer(const websocketpp::lib::error_code& errorCode);
+
+	ConnectionSnapshot connections();
+	ConnectionPropertiesPtr connectionProperties(connection_hdl hdl);
+	void addConnection(connection_hdl hdl, ConnectionPropertiesPtr connProperties);
+	void removeConnection(connection_hdl hdl);
+
+	void flushBroadcasts();
+	static server::message_ptr makeCompressibleMessage(server::message_ptr message);
+	bool sendMessage(connection_hdl hdl, ConnectionProperties& connProperties,
+		server::message_ptr message, server::message_ptr& compressibleMessage,
+		bool droppable);
+	bool evictIfSlow(server::connection_ptr conn,
+		ConnectionProperties& connProperties, size_t pendingBytes);
+	void evictConnection(server::connection_ptr conn, const char* reason);
+	void scheduleReaper();
+	void reapConnections();
+	void reapConnection(server::connection_ptr conn, const char* reason);
 
 	QString getRemoteEndpoint(connection_hdl hdl);
-	void notifyConnection(QString clientIp);
-	void notifyDisconnection(QString clientIp);
 
 	server _server;
 	quint16 _serverPort;
-	std::set<connection_hdl, std::owner_less<connection_hdl>> _connections;
-	std::map<connection_hdl, ConnectionProperties, std::owner_less<connection_hdl>> _connectionProperties;
+	int _ioThreadCount;
+	// Immutable snapshot, replaced as a whole (under _clMutex) when a client
+	// connects or disconnects. Readers only load the current pointer, with
+	// std::atomic_load, which isn't lock-free: libstdc++ guards shared_ptr
+	// atomic operations with a small pool of spinlocks picked by address.
+	// Readers still never wait for _clMutex, nor for the map to be copied,
+	// only for the pointer and reference count to be read.
+	ConnectionSnapshot _connections;
 	QMutex _clMutex;
 	QThreadPool _threadPool;
+	QThreadPool _ioThreadPool;
+	std::atomic<int> _runningIoThreads;
+	// Set by stop() until its io threads have exited. Each stop() gets its
+	// own generation, so that a handshake timeout armed by an earlier one
+	// is ignored.
+	std::atomic<bool> _stopping;
+	std::atomic<uint64_t> _stopGeneration;
+	uint64_t _stopStartTime;
+	WSLocalServer* _localServer;
+	QString _localSocketPath;
+	QThread _localServerThread;
+	// Created with the server, on the UI thread
+	ConnectionNotifier _notifier;
+	std::atomic<uint64_t> _droppedMessages;
+	std::atomic<uint64_t> _evictedConnections;
+	std::atomic<uint64_t> _reapedConnections;
+	// Updates waiting for the next flush on the io threads
+	std::vector<std::pair<server::message_ptr, bool>> _pendingBroadcasts;
+	QMutex _broadcastMutex;
+	// Serializes the flushes, which would otherwise run concurrently on the io threads
+	std::unique_ptr<websocketpp::lib::asio::io_service::strand> _broadcastStrand;
+	std::atomic<uint64_t> _broadcastFlushes;
+	// Periodic ping/idle check, running on the io threads while the server
+	// listens. Guarded by _reaperMutex since stop() cancels it from another thread.
+	server::timer_ptr _reaperTimer;
+	bool _reaperActive;
+	QMutex _reaperMutex;
 };
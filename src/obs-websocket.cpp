@@ -28,6 +28,7 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include "WSServer.h"
 #include "WSEvents.h"
 #include "Config.h"
+#include "UIThreadExecutor.h"
 #include "forms/settings-dialog.h"
 
 void ___source_dummy_addref(obs_source_t*) {}
@@ -58,7 +59,7 @@ bool obs_module_load(void) {
 	_config->MigrateFromGlobalSettings(); // TODO remove this on the next minor jump
 	_config->Load();
 
-	_server = WSServerPtr(new WSServer());
+	_server = WSServerPtr(new WSServer(), WSServer::destroy);
 	_eventsSystem = WSEventsPtr(new WSEvents(_server));
 
 	// UI setup
@@ -95,11 +96,26 @@ bool obs_module_load(void) {
 }
 
 void obs_module_unload() {
-	_server->stop();
-
-	_eventsSystem.reset();
-	_server.reset();
-	_config.reset();
+	// The UI event loop has ended: requests waiting for it would never
+	// complete
+	UIThreadExecutor::shutdown();
+
+	// Returns once the io threads have exited: they read the settings too
+	_server->shutdown();
+
+	// Requests no longer wait for the UI thread: give them a moment to
+	// complete before libobs shuts down
+	bool requestsDone = _server->threadPool()->waitForDone(1000);
+
+	if (requestsDone) {
+		_eventsSystem.reset();
+		_server.reset();
+		_config.reset();
+	} else {
+		// Still used by the requests, through GetEventsSystem() and
+		// GetConfig(): left to the process exit
+		blog(LOG_WARNING, "requests still running on unload, keeping the server and settings alive");
+	}
 
 	blog(LOG_INFO, "goodbye!");
 }
@@ -0,0 +1,599 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+// obs-websocket-bench: request dispatch microbenchmarks, running the real
+// request handlers against the headless libobs stand-in. Each case is timed
+// end to end through WSRequestHandler::processIncomingMessage, then stage by
+// stage:
+//   index      RequestView::parse, validating and indexing the payload in place
+//   lookup     request table lookup
+//   obs-data   obs_data_create_from_json, for handlers that don't read their
+//              parameters from the view (zero for those that do)
+//   has-field  "request-type"/"message-id" validation
+//   handler    handler execution, including its SendResponse call
+//   write      JsonWriter serialization of the response
+// plus, timed separately for comparison, what every request went through
+// before the view and the writer:
+//   legacy-parse      copy of the payload and obs_data_create_from_json
+//   legacy-serialize  obs_data_apply of the handler's fields into a new
+//                     obs_data, then obs_data_get_json
+// Heap allocations (operator new, which the stand-in's obs_data goes through)
+// are counted end to end and for both serializations.
+// With --server-restarts, the websocket server is also stopped and restarted
+// with clients connected (see ServerRestartBenchmark).
+// Results are nanosecond percentiles, written as JSON.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtWidgets/QApplication>
+
+#include <obs-module.h>
+#include <util/platform.h>
+
+#include <websocketpp/config/asio_no_tls_client.hpp>
+#include <websocketpp/client.hpp>
+
+#include "headless-obs.h"
+#include "LatencyStats.h"
+
+#include "obs-websocket.h"
+#include "Config.h"
+#include "RequestArena.h"
+#include "WSServer.h"
+#include "WSEvents.h"
+#include "WSRequestHandler.h"
+
+// --- Allocation counting ---
+
+static std::atomic<uint64_t> allocationCount(0);
+
+void* operator new(size_t size) {
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	void* ptr = malloc(size ? size : 1);
+	if (!ptr) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+	free(ptr);
+}
+
+// --- Symbols normally provided by obs-websocket.cpp ---
+
+void ___source_dummy_addref(obs_source_t*) {}
+void ___sceneitem_dummy_addref(obs_sceneitem_t*) {}
+void ___data_dummy_addref(obs_data_t*) {}
+void ___data_array_dummy_addref(obs_data_array_t*) {}
+void ___output_dummy_addref(obs_output_t*) {}
+
+void ___data_item_dummy_addref(obs_data_item_t*) {}
+void ___data_item_release(obs_data_item_t* dataItem) {
+	obs_data_item_release(&dataItem);
+}
+
+const char* obs_module_text(const char* lookup_string) {
+	return lookup_string;
+}
+
+ConfigPtr _config;
+WSServerPtr _server;
+WSEventsPtr _eventsSystem;
+
+ConfigPtr GetConfig() {
+	return _config;
+}
+
+WSServerPtr GetServer() {
+	return _server;
+}
+
+WSEventsPtr GetEventsSystem() {
+	return _eventsSystem;
+}
+
+// --- Benchmark ---
+
+struct BenchmarkCase {
+	const char* name;
+	const char* requestType;
+	std::function<void(QJsonObject&)> addParameters;
+};
+
+struct BenchmarkOptions {
+	int iterations;
+	int warmup;
+	int scenes;
+	int inputs;
+	std::vector<int> payloadFields;
+	QStringList cases;
+};
+
+static std::vector<BenchmarkCase> benchmarkCases() {
+	return {
+		{ "GetVersion", "GetVersion", [](QJsonObject&) {} },
+		{ "GetCurrentScene", "GetCurrentScene", [](QJsonObject&) {} },
+		{ "GetSceneList", "GetSceneList", [](QJsonObject&) {} },
+		{ "GetSourcesList", "GetSourcesList", [](QJsonObject&) {} },
+		{ "GetSceneItemProperties", "GetSceneItemProperties", [](QJsonObject& request) {
+			request["scene-name"] = "Scene 1";
+			request["item"] = "Input 1";
+		} },
+		{ "SetSceneItemProperties", "SetSceneItemProperties", [](QJsonObject& request) {
+			request["scene-name"] = "Scene 1";
+			request["item"] = "Input 1";
+			request["position"] = QJsonObject { { "x", 10.5 }, { "y", 20.5 } };
+			request["scale"] = QJsonObject { { "x", 1.0 }, { "y", 1.0 } };
+			request["rotation"] = 0.0;
+			request["visible"] = true;
+		} },
+		{ "SetSourceSettings", "SetSourceSettings", [](QJsonObject& request) {
+			request["sourceName"] = "Input 1";
+			request["sourceSettings"] = QJsonObject { { "color", 4278190335.0 } };
+		} },
+		{ "SetVolume", "SetVolume", [](QJsonObject& request) {
+			request["source"] = "Input 1";
+			request["volume"] = 0.5;
+		} },
+		{ "SetSceneItemRender", "SetSceneItemRender", [](QJsonObject& request) {
+			request["scene-name"] = "Scene 1";
+			request["source"] = "Input 1";
+			request["render"] = true;
+		} },
+		{ "InvalidRequestType", "DoesNotExist", [](QJsonObject&) {} }
+	};
+}
+
+static std::string buildPayload(const BenchmarkCase& benchmarkCase, int paddingFields) {
+	QJsonObject request;
+	request["request-type"] = benchmarkCase.requestType;
+	request["message-id"] = "bench";
+	benchmarkCase.addParameters(request);
+
+	// Unused fields: they only weigh on parsing and field lookups
+	for (int i = 0; i < paddingFields; i++) {
+		request[QString("padding-%1").arg(i)] = "0123456789abcdef";
+	}
+
+	return QJsonDocument(request).toJson(QJsonDocument::Compact).toStdString();
+}
+
+class RequestDispatchBenchmark
+{
+public:
+	RequestDispatchBenchmark(const BenchmarkCase& benchmarkCase, std::string payload)
+		: _case(benchmarkCase),
+		  _payload(std::move(payload)),
+		  _responseBytes(0)
+	{
+	}
+
+	void run(int warmup, int iterations) {
+		for (int i = 0; i < warmup; i++) {
+			runEndToEnd(false);
+			runStages(false);
+		}
+
+		for (int i = 0; i < iterations; i++) {
+			runEndToEnd(true);
+			runStages(true);
+		}
+	}
+
+	QJsonObject results() {
+		QJsonObject stages;
+		stages["index"] = _index.summarize();
+		stages["lookup"] = _lookup.summarize();
+		stages["obs-data"] = _obsData.summarize();
+		stages["has-field"] = _hasField.summarize();
+		stages["handler"] = _handler.summarize();
+		stages["write"] = _write.summarize();
+		stages["legacy-parse"] = _legacyParse.summarize();
+		stages["legacy-serialize"] = _legacySerialize.summarize();
+
+		QJsonObject allocations;
+		allocations["end-to-end"] = _endToEndAllocations.summarize();
+		allocations["write"] = _writeAllocations.summarize();
+		allocations["legacy-serialize"] = _legacySerializeAllocations.summarize();
+
+		QJsonObject result;
+		result["case"] = _case.name;
+		result["request-type"] = _case.requestType;
+		result["request-bytes"] = (double)_payload.size();
+		result["response-bytes"] = (double)_responseBytes;
+		result["status"] = _status;
+		result["end-to-end"] = _endToEnd.summarize();
+		result["stages"] = stages;
+		result["allocations"] = allocations;
+		return result;
+	}
+
+private:
+	void runEndToEnd(bool record) {
+		WSRequestHandler handler(_connProperties);
+		// The payload is parsed in place, like the server's own copy
+		std::string payload(_payload);
+
+		uint64_t allocationsBefore = allocationCount.load();
+		uint64_t start = os_gettime_ns();
+		std::string response = handler.processIncomingMessage(payload);
+		uint64_t end = os_gettime_ns();
+		uint64_t allocations = allocationCount.load() - allocationsBefore;
+
+		if (record) {
+			_endToEnd.add((double)(end - start));
+			_endToEndAllocations.add((double)allocations);
+			_responseBytes = response.size();
+		}
+	}
+
+	// Mirrors WSRequestHandler::processRequest, with a timestamp between stages
+	void runStages(bool record) {
+		WSRequestHandler req(_connProperties);
+		std::string payload(_payload);
+		RequestArena::Scope arenaScope;
+
+		uint64_t t0 = os_gettime_ns();
+		bool valid = req._view.parse(payload);
+		uint64_t t1 = os_gettime_ns();
+
+		const char* requestTypeName;
+		size_t requestTypeLength;
+		const WSRequestHandler::RequestType* requestType = nullptr;
+		if (valid && req._view.peekString("request-type", requestTypeName, requestTypeLength)) {
+			requestType = WSRequestHandler::findRequestType(requestTypeName, requestTypeLength);
+		}
+		uint64_t t2 = os_gettime_ns();
+
+		if (valid && (!requestType || !(requestType->flags & WSRequestHandler::InPlaceParameters))) {
+			req.data = obs_data_create_from_json(payload.c_str());
+		}
+		uint64_t t3 = os_gettime_ns();
+
+		valid = valid && req.hasField("request-type") && req.hasField("message-id");
+		if (valid) {
+			req._requestType = req.getString("request-type");
+			req._messageId = req.getString("message-id");
+		}
+		uint64_t t4 = os_gettime_ns();
+
+		OBSDataAutoRelease fields = (valid && requestType)
+			? req.runHandler(requestType)
+			: req.SendErrorResponse("invalid request type");
+		uint64_t t5 = os_gettime_ns();
+
+		uint64_t writeAllocations = allocationCount.load();
+		std::string response;
+		req.writeResponse(response, fields);
+		uint64_t t6 = os_gettime_ns();
+		writeAllocations = allocationCount.load() - writeAllocations;
+
+		uint64_t legacySerializeAllocations = allocationCount.load();
+		OBSDataAutoRelease legacyResponse = req.responseData(fields);
+		std::string legacyJson = obs_data_get_json(legacyResponse);
+		uint64_t t7 = os_gettime_ns();
+		legacySerializeAllocations = allocationCount.load() - legacySerializeAllocations;
+
+		std::string legacyContainer(_payload);
+		OBSDataAutoRelease legacyData = obs_data_create_from_json(legacyContainer.c_str());
+		uint64_t t8 = os_gettime_ns();
+
+		if (record) {
+			_index.add((double)(t1 - t0));
+			_lookup.add((double)(t2 - t1));
+			_obsData.add((double)(t3 - t2));
+			_hasField.add((double)(t4 - t3));
+			_handler.add((double)(t5 - t4));
+			_write.add((double)(t6 - t5));
+			_legacySerialize.add((double)(t7 - t6));
+			_legacyParse.add((double)(t8 - t7));
+			_writeAllocations.add((double)writeAllocations);
+			_legacySerializeAllocations.add((double)legacySerializeAllocations);
+			_status = req._responseStatus;
+		}
+	}
+
+	const BenchmarkCase& _case;
+	std::string _payload;
+	ConnectionProperties _connProperties;
+	size_t _responseBytes;
+	QString _status;
+
+	LatencyStats _endToEnd;
+	LatencyStats _index;
+	LatencyStats _lookup;
+	LatencyStats _obsData;
+	LatencyStats _hasField;
+	LatencyStats _handler;
+	LatencyStats _write;
+	LatencyStats _legacyParse;
+	LatencyStats _legacySerialize;
+	LatencyStats _endToEndAllocations;
+	LatencyStats _writeAllocations;
+	LatencyStats _legacySerializeAllocations;
+};
+
+// --- Server stop/restart benchmark ---
+
+typedef websocketpp::client<websocketpp::config::asio_client> BenchClient;
+
+// Starts the websocket server, connects clients to it and, once they're all
+// registered, times:
+//   stop-call      stop() returning, which is what the UI thread waits for
+//   stop-complete  stop() to the io threads exiting, closing handshakes included
+//   start          start() returning
+// The clients reconnect after each restart. UI thread events (stop's
+// handshake timeout, connection notifications) are processed while waiting.
+class ServerRestartBenchmark
+{
+public:
+	ServerRestartBenchmark(quint16 port, int clients)
+		: _port(port),
+		  _clients(clients),
+		  _openClients(0)
+	{
+		_endpoint.clear_access_channels(websocketpp::log::alevel::all);
+		_endpoint.clear_error_channels(websocketpp::log::elevel::all);
+		_endpoint.init_asio();
+		_endpoint.start_perpetual();
+		_ioThread = std::thread([this]() {
+			_endpoint.run();
+		});
+	}
+
+	~ServerRestartBenchmark() {
+		_endpoint.stop_perpetual();
+		_endpoint.stop();
+		_ioThread.join();
+	}
+
+	bool run(int restarts) {
+		for (int i = 0; i < restarts; i++) {
+			uint64_t startBegin = os_gettime_ns();
+			_server->start(_port);
+			uint64_t startEnd = os_gettime_ns();
+
+			if (!connectClients()) {
+				return false;
+			}
+
+			uint64_t stopBegin = os_gettime_ns();
+			_server->stop();
+			uint64_t stopReturned = os_gettime_ns();
+			if (!waitFor([]() { return _server->isStopped(); })) {
+				fprintf(stderr, "server restart: server didn't stop\n");
+				return false;
+			}
+			uint64_t stopEnd = os_gettime_ns();
+
+			_start.add((double)(startEnd - startBegin));
+			_stopCall.add((double)(stopReturned - stopBegin));
+			_stopComplete.add((double)(stopEnd - stopBegin));
+
+			// Let the clients see their connections closed
+			waitFor([this]() { return _openClients.load() == 0; });
+		}
+		return true;
+	}
+
+	QJsonObject results() {
+		QJsonObject result;
+		result["port"] = _port;
+		result["clients"] = _clients;
+		result["stop-call"] = _stopCall.summarize();
+		result["stop-complete"] = _stopComplete.summarize();
+		result["start"] = _start.summarize();
+		return result;
+	}
+
+private:
+	bool connectClients() {
+		std::string url = "ws://127.0.0.1:" + std::to_string(_port);
+		for (int i = 0; i < _clients; i++) {
+			websocketpp::lib::error_code errorCode;
+			BenchClient::connection_ptr conn = _endpoint.get_connection(url, errorCode);
+			if (errorCode) {
+				fprintf(stderr, "server restart: %s\n", errorCode.message().c_str());
+				return false;
+			}
+			conn->set_open_handler([this](websocketpp::connection_hdl) {
+				_openClients++;
+			});
+			conn->set_close_handler([this](websocketpp::connection_hdl) {
+				_openClients--;
+			});
+			_endpoint.connect(conn);
+		}
+
+		// Both ends must have the connections: the server registers them in
+		// its own open handler
+		bool connected = waitFor([this]() {
+			OBSDataAutoRelease stats = _server->GetStats();
+			return _openClients.load() == _clients
+				&& obs_data_get_int(stats, "connections") == _clients;
+		});
+		if (!connected) {
+			fprintf(stderr, "server restart: clients failed to connect to port %d\n", _port);
+		}
+		return connected;
+	}
+
+	static bool waitFor(std::function<bool()> condition) {
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+		while (!condition()) {
+			if (std::chrono::steady_clock::now() > deadline) {
+				return false;
+			}
+			QCoreApplication::processEvents();
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+		return true;
+	}
+
+	quint16 _port;
+	int _clients;
+	BenchClient _endpoint;
+	std::thread _ioThread;
+	std::atomic<int> _openClients;
+
+	LatencyStats _stopCall;
+	LatencyStats _stopComplete;
+	LatencyStats _start;
+};
+
+static bool parseFieldCounts(const QString& value, std::vector<int>& counts) {
+	for (const QString& entry : value.split(',', QString::SkipEmptyParts)) {
+		bool ok = false;
+		int count = entry.trimmed().toInt(&ok);
+		if (!ok || count < 0) {
+			return false;
+		}
+		counts.push_back(count);
+	}
+	return !counts.empty();
+}
+
+int main(int argc, char* argv[])
+{
+	// Handlers and WSEvents use Qt widgets helpers; no display is needed
+	if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+		qputenv("QT_QPA_PLATFORM", "offscreen");
+	}
+	QApplication app(argc, argv);
+	app.setApplicationName("obs-websocket-bench");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Request dispatch microbenchmarks for obs-websocket");
+	parser.addHelpOption();
+
+	QCommandLineOption iterationsOption("iterations", "Measured iterations per case.", "count", "10000");
+	QCommandLineOption warmupOption("warmup", "Unmeasured iterations per case.", "count", "1000");
+	QCommandLineOption scenesOption("scenes", "Number of scenes in the synthetic collection.", "count", "10");
+	QCommandLineOption inputsOption("inputs", "Number of inputs, each present in every scene.", "count", "20");
+	QCommandLineOption payloadOption("payload-fields",
+		"Padding field counts to run each case with, separated by commas.", "counts", "0,16,256");
+	QCommandLineOption casesOption("cases", "Cases to run, separated by commas (default: all).", "names");
+	QCommandLineOption restartsOption("server-restarts",
+		"Number of websocket server stop/restart cycles to time, 0 to skip.", "count", "0");
+	QCommandLineOption restartClientsOption("server-clients",
+		"Clients connected during each stop/restart cycle.", "count", "10");
+	QCommandLineOption restartPortOption("server-port",
+		"Port of the websocket server for stop/restart cycles.", "port", "4455");
+	QCommandLineOption outputOption("output", "Write results to this file instead of stdout.", "path");
+
+	parser.addOptions({ iterationsOption, warmupOption, scenesOption, inputsOption,
+		payloadOption, casesOption, restartsOption, restartClientsOption, restartPortOption,
+		outputOption });
+	parser.process(app);
+
+	BenchmarkOptions options;
+	options.iterations = std::max(1, parser.value(iterationsOption).toInt());
+	options.warmup = std::max(0, parser.value(warmupOption).toInt());
+	options.scenes = std::max(1, parser.value(scenesOption).toInt());
+	options.inputs = std::max(1, parser.value(inputsOption).toInt());
+	options.cases = parser.value(casesOption).split(',', QString::SkipEmptyParts);
+	if (!parseFieldCounts(parser.value(payloadOption), options.payloadFields)) {
+		fprintf(stderr, "invalid payload field counts\n");
+		return 1;
+	}
+
+	headless_obs_set_log_level(LOG_WARNING);
+	headless_obs_startup(options.scenes, options.inputs);
+
+	_config = ConfigPtr(new Config());
+	_server = WSServerPtr(new WSServer(), WSServer::destroy);
+	_eventsSystem = WSEventsPtr(new WSEvents(_server));
+
+	QJsonArray results;
+	for (const BenchmarkCase& benchmarkCase : benchmarkCases()) {
+		if (!options.cases.isEmpty() && !options.cases.contains(benchmarkCase.name)) {
+			continue;
+		}
+
+		for (int paddingFields : options.payloadFields) {
+			RequestDispatchBenchmark benchmark(benchmarkCase, buildPayload(benchmarkCase, paddingFields));
+			benchmark.run(options.warmup, options.iterations);
+
+			QJsonObject result = benchmark.results();
+			result["payload-fields"] = paddingFields;
+			results.append(result);
+		}
+	}
+
+	QJsonObject serverRestart;
+	int restarts = std::max(0, parser.value(restartsOption).toInt());
+	if (restarts > 0) {
+		ServerRestartBenchmark benchmark((quint16)parser.value(restartPortOption).toUInt(),
+			std::max(1, parser.value(restartClientsOption).toInt()));
+		if (!benchmark.run(restarts)) {
+			return 1;
+		}
+		serverRestart = benchmark.results();
+	}
+
+	// Same teardown as the module unload
+	_server->shutdown();
+	_eventsSystem.reset();
+	_server.reset();
+	_config.reset();
+	headless_obs_shutdown();
+
+	QJsonObject config;
+	config["iterations"] = options.iterations;
+	config["warmup"] = options.warmup;
+	config["scenes"] = options.scenes;
+	config["inputs"] = options.inputs;
+
+	QJsonObject report;
+	report["benchmark"] = "request-dispatch";
+	report["unit"] = "ns";
+	report["config"] = config;
+	report["results"] = results;
+	if (!serverRestart.isEmpty()) {
+		report["server-restart"] = serverRestart;
+	}
+
+	QByteArray output = QJsonDocument(report).toJson(QJsonDocument::Indented);
+	if (parser.isSet(outputOption)) {
+		QFile file(parser.value(outputOption));
+		if (!file.open(QIODevice::WriteOnly)) {
+			fprintf(stderr, "can't write %s\n", parser.value(outputOption).toUtf8().constData());
+			return 1;
+		}
+		file.write(output);
+	} else {
+		fwrite(output.constData(), 1, output.size(), stdout);
+	}
+
+	return 0;
+}
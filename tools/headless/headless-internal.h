@@ -0,0 +1,144 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <obs.h>
+#include <obs-frontend-api.h>
+
+// Object model behind the stand-in implementation of the libobs API.
+// Reference counted objects are freed when their count drops to zero, like
+// their libobs counterparts.
+
+struct obs_data_item {
+	std::atomic<long> refs;
+	obs_data_t* parent;
+	size_t index;
+	std::string name;
+	enum obs_data_type type;
+	enum obs_data_number_type numType;
+	std::string stringValue;
+	long long intValue;
+	double doubleValue;
+	bool boolValue;
+	obs_data_t* objValue;
+	obs_data_array_t* arrayValue;
+};
+
+struct obs_data {
+	std::atomic<long> refs;
+	std::vector<obs_data_item_t*> items;
+	std::string json;
+};
+
+struct obs_data_array {
+	std::atomic<long> refs;
+	std::vector<obs_data_t*> objects;
+};
+
+struct obs_source {
+	std::atomic<long> refs;
+	std::string id;
+	std::string name;
+	enum obs_source_type type;
+	obs_data_t* settings;
+	obs_data_t* privateSettings;
+	float volume;
+	bool muted;
+	int64_t syncOffset;
+	uint32_t width;
+	uint32_t height;
+	std::vector<obs_source_t*> filters;
+	obs_scene_t* scene;
+	bool registered;
+};
+
+struct obs_scene {
+	obs_source_t* source;
+	std::vector<obs_sceneitem_t*> items;
+	int64_t nextItemId;
+};
+
+struct obs_scene_item {
+	std::atomic<long> refs;
+	obs_scene_t* parent;
+	obs_source_t* source;
+	int64_t id;
+	struct vec2 pos;
+	struct vec2 scale;
+	struct vec2 bounds;
+	float rot;
+	uint32_t alignment;
+	uint32_t boundsAlignment;
+	enum obs_bounds_type boundsType;
+	struct obs_sceneitem_crop crop;
+	bool visible;
+	bool locked;
+};
+
+struct obs_output {
+	std::atomic<long> refs;
+	std::string id;
+	std::string name;
+	obs_data_t* settings;
+	uint32_t flags;
+	bool active;
+	uint64_t startTime;
+};
+
+struct obs_service {
+	std::atomic<long> refs;
+	std::string id;
+	std::string name;
+	obs_data_t* settings;
+};
+
+struct config_data {
+	std::mutex mutex;
+	std::map<std::string, std::map<std::string, std::string>> values;
+	std::map<std::string, std::map<std::string, std::string>> defaults;
+};
+
+namespace headless {
+	// Guards the source registry, the scene graph and the frontend state
+	std::recursive_mutex& graphMutex();
+
+	obs_source_t* createSource(const char* id, const char* name, enum obs_source_type type,
+		obs_data_t* settings, bool registered);
+	void registerSource(obs_source_t* source);
+	std::vector<obs_source_t*> registeredSources();
+	void clearSources();
+
+	obs_output_t* createOutput(const char* id, const char* name, uint32_t flags);
+	void clearOutputs();
+
+	void emitFrontendEvent(enum obs_frontend_event event);
+	void setFrontendScenes(const std::vector<obs_source_t*>& scenes,
+		const std::vector<obs_source_t*>& transitions);
+	void clearFrontend();
+
+	// Resolved through os_dlsym(), since older frontend headers lack them
+	bool recordingPaused();
+	void pauseRecording(bool pause);
+}
@@ -0,0 +1,67 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <string>
+#include <vector>
+
+#include "headless-obs.h"
+#include "headless-internal.h"
+
+void headless_obs_startup(size_t scene_count, size_t input_count)
+{
+	std::vector<obs_source_t*> scenes;
+	for (size_t i = 1; i <= scene_count; i++) {
+		std::string name = "Scene " + std::to_string(i);
+		scenes.push_back(obs_source_create("scene", name.c_str(), nullptr, nullptr));
+	}
+
+	for (size_t i = 1; i <= input_count; i++) {
+		std::string name = "Input " + std::to_string(i);
+		obs_data_t* settings = obs_get_source_defaults("color_source");
+		obs_data_set_int(settings, "color", 0xFF000000 | (uint32_t)(i * 0x10101));
+		obs_source_t* input = obs_source_create("color_source", name.c_str(), settings, nullptr);
+		obs_data_release(settings);
+
+		// Scenes own the input through their items
+		for (obs_source_t* scene : scenes) {
+			obs_scene_add(obs_scene_from_source(scene), input);
+		}
+		obs_source_release(input);
+	}
+
+	std::vector<obs_source_t*> transitions = {
+		obs_source_create_private("fade_transition", "Fade", nullptr),
+		obs_source_create_private("cut_transition", "Cut", nullptr)
+	};
+
+	headless::setFrontendScenes(scenes, transitions);
+	blog(LOG_INFO, "headless: started with %d scenes of %d inputs",
+		(int)scene_count, (int)input_count);
+}
+
+void headless_obs_shutdown(void)
+{
+	headless::clearFrontend();
+	headless::clearOutputs();
+	headless::clearSources();
+}
+
+void headless_obs_emit_frontend_event(enum obs_frontend_event event)
+{
+	headless::emitFrontendEvent(event);
+}
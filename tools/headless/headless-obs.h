@@ -0,0 +1,49 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+#include <obs-frontend-api.h>
+
+/**
+ * Control API of the headless libobs/frontend stand-in.
+ *
+ * Startup builds a synthetic scene collection: `input_count` color sources
+ * ("Input 1" ... "Input N") shared by `scene_count` scenes ("Scene 1" ...
+ * "Scene N"), the "Fade" and "Cut" transitions, the streaming, recording and
+ * replay buffer outputs and an rtmp_common streaming service. The first scene
+ * is the program scene and "Fade" the current transition.
+ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void headless_obs_startup(size_t scene_count, size_t input_count);
+void headless_obs_shutdown(void);
+
+// Invokes the registered frontend callbacks, as OBS would from its UI thread
+void headless_obs_emit_frontend_event(enum obs_frontend_event event);
+
+// Messages above this level (LOG_ERROR, LOG_WARNING, LOG_INFO, LOG_DEBUG) are dropped
+void headless_obs_set_log_level(int level);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,910 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <obs-data.h>
+#include <util/base.h>
+
+#include "headless-internal.h"
+
+// In-memory obs_data with a self-contained JSON reader and writer. Items keep
+// their insertion order and the writer mirrors jansson's 4-space indented
+// output, so payloads look the same as they do under a real OBS.
+
+static obs_data_item_t* createItem(obs_data_t* data, const char* name)
+{
+	obs_data_item_t* item = new obs_data_item_t();
+	item->refs = 1;
+	item->parent = data;
+	item->index = data->items.size();
+	item->name = name;
+	item->type = OBS_DATA_NULL;
+	item->numType = OBS_DATA_NUM_INVALID;
+	item->intValue = 0;
+	item->doubleValue = 0.0;
+	item->boolValue = false;
+	item->objValue = nullptr;
+	item->arrayValue = nullptr;
+	data->items.push_back(item);
+	return item;
+}
+
+static void clearItemValue(obs_data_item_t* item)
+{
+	if (item->objValue) {
+		obs_data_release(item->objValue);
+		item->objValue = nullptr;
+	}
+	if (item->arrayValue) {
+		obs_data_array_release(item->arrayValue);
+		item->arrayValue = nullptr;
+	}
+	item->stringValue.clear();
+	item->type = OBS_DATA_NULL;
+	item->numType = OBS_DATA_NUM_INVALID;
+}
+
+static obs_data_item_t* findItem(obs_data_t* data, const char* name)
+{
+	if (!data || !name) {
+		return nullptr;
+	}
+
+	for (obs_data_item_t* item : data->items) {
+		if (item->name == name) {
+			return item;
+		}
+	}
+	return nullptr;
+}
+
+static obs_data_item_t* prepareItem(obs_data_t* data, const char* name)
+{
+	if (!data || !name) {
+		return nullptr;
+	}
+
+	obs_data_item_t* item = findItem(data, name);
+	if (item) {
+		clearItemValue(item);
+		return item;
+	}
+	return createItem(data, name);
+}
+
+static void itemRelease(obs_data_item_t* item)
+{
+	if (item && --item->refs == 0) {
+		clearItemValue(item);
+		delete item;
+	}
+}
+
+// --- JSON reader ---
+
+namespace {
+	class JsonReader {
+	public:
+		explicit JsonReader(const char* json)
+			: _pos(json)
+		{
+		}
+
+		obs_data_t* parseDocument()
+		{
+			skipWhitespace();
+			if (*_pos != '{') {
+				return nullptr;
+			}
+
+			obs_data_t* data = obs_data_create();
+			if (!parseObject(data)) {
+				obs_data_release(data);
+				return nullptr;
+			}
+
+			skipWhitespace();
+			if (*_pos != '\0') {
+				obs_data_release(data);
+				return nullptr;
+			}
+			return data;
+		}
+
+	private:
+		void skipWhitespace()
+		{
+			while (*_pos == ' ' || *_pos == '\t' || *_pos == '\n' || *_pos == '\r') {
+				_pos++;
+			}
+		}
+
+		bool consume(char c)
+		{
+			skipWhitespace();
+			if (*_pos != c) {
+				return false;
+			}
+			_pos++;
+			return true;
+		}
+
+		bool consumeLiteral(const char* literal)
+		{
+			size_t len = strlen(literal);
+			if (strncmp(_pos, literal, len) != 0) {
+				return false;
+			}
+			_pos += len;
+			return true;
+		}
+
+		static void appendUtf8(std::string& out, uint32_t cp)
+		{
+			if (cp < 0x80) {
+				out += (char)cp;
+			} else if (cp < 0x800) {
+				out += (char)(0xC0 | (cp >> 6));
+				out += (char)(0x80 | (cp & 0x3F));
+			} else if (cp < 0x10000) {
+				out += (char)(0xE0 | (cp >> 12));
+				out += (char)(0x80 | ((cp >> 6) & 0x3F));
+				out += (char)(0x80 | (cp & 0x3F));
+			} else {
+				out += (char)(0xF0 | (cp >> 18));
+				out += (char)(0x80 | ((cp >> 12) & 0x3F));
+				out += (char)(0x80 | ((cp >> 6) & 0x3F));
+				out += (char)(0x80 | (cp & 0x3F));
+			}
+		}
+
+		bool parseHex4(uint32_t& value)
+		{
+			value = 0;
+			for (int i = 0; i < 4; i++) {
+				char c = *_pos++;
+				value <<= 4;
+				if (c >= '0' && c <= '9') {
+					value |= (uint32_t)(c - '0');
+				} else if (c >= 'a' && c <= 'f') {
+					value |= (uint32_t)(c - 'a' + 10);
+				} else if (c >= 'A' && c <= 'F') {
+					value |= (uint32_t)(c - 'A' + 10);
+				} else {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		bool parseString(std::string& out)
+		{
+			if (!consume('"')) {
+				return false;
+			}
+
+			out.clear();
+			while (*_pos != '"') {
+				char c = *_pos++;
+				if (c == '\0' || (unsigned char)c < 0x20) {
+					return false;
+				}
+				if (c != '\\') {
+					out += c;
+					continue;
+				}
+
+				c = *_pos++;
+				switch (c) {
+					case '"': out += '"'; break;
+					case '\\': out += '\\'; break;
+					case '/': out += '/'; break;
+					case 'b': out += '\b'; break;
+					case 'f': out += '\f'; break;
+					case 'n': out += '\n'; break;
+					case 'r': out += '\r'; break;
+					case 't': out += '\t'; break;
+					case 'u': {
+						uint32_t cp;
+						if (!parseHex4(cp)) {
+							return false;
+						}
+						if (cp >= 0xD800 && cp <= 0xDBFF) {
+							uint32_t low;
+							if (!consumeLiteral("\\u") || !parseHex4(low)
+								|| low < 0xDC00 || low > 0xDFFF)
+							{
+								return false;
+							}
+							cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+						}
+						appendUtf8(out, cp);
+						break;
+					}
+					default:
+						return false;
+				}
+			}
+			_pos++;
+			return true;
+		}
+
+		bool parseNumber(obs_data_t* data, const std::string& name)
+		{
+			const char* start = _pos;
+			bool isReal = false;
+
+			if (*_pos == '-') {
+				_pos++;
+			}
+			if (*_pos < '0' || *_pos > '9') {
+				return false;
+			}
+			while ((*_pos >= '0' && *_pos <= '9') || *_pos == '.' || *_pos == 'e'
+				|| *_pos == 'E' || *_pos == '+' || *_pos == '-')
+			{
+				if (*_pos == '.' || *_pos == 'e' || *_pos == 'E') {
+					isReal = true;
+				}
+				_pos++;
+			}
+
+			std::string number(start, _pos - start);
+			if (isReal) {
+				obs_data_set_double(data, name.c_str(), strtod(number.c_str(), nullptr));
+			} else {
+				obs_data_set_int(data, name.c_str(), strtoll(number.c_str(), nullptr, 10));
+			}
+			return true;
+		}
+
+		// Only objects are kept in arrays, like libobs does
+		bool parseArray(obs_data_array_t* array)
+		{
+			if (!consume('[')) {
+				return false;
+			}
+			if (consume(']')) {
+				return true;
+			}
+
+			do {
+				skipWhitespace();
+				if (*_pos == '{') {
+					obs_data_t* obj = obs_data_create();
+					bool ok = parseObject(obj);
+					if (ok) {
+						obs_data_array_push_back(array, obj);
+					}
+					obs_data_release(obj);
+					if (!ok) {
+						return false;
+					}
+				} else if (!skipValue()) {
+					return false;
+				}
+			} while (consume(','));
+
+			return consume(']');
+		}
+
+		bool skipValue()
+		{
+			obs_data_t* scratch = obs_data_create();
+			bool ok = parseValue(scratch, "");
+			obs_data_release(scratch);
+			return ok;
+		}
+
+		bool parseValue(obs_data_t* data, const std::string& name)
+		{
+			skipWhitespace();
+			switch (*_pos) {
+				case '{': {
+					obs_data_t* obj = obs_data_create();
+					bool ok = parseObject(obj);
+					if (ok) {
+						obs_data_set_obj(data, name.c_str(), obj);
+					}
+					obs_data_release(obj);
+					return ok;
+				}
+				case '[': {
+					obs_data_array_t* array = obs_data_array_create();
+					bool ok = parseArray(array);
+					if (ok) {
+						obs_data_set_array(data, name.c_str(), array);
+					}
+					obs_data_array_release(array);
+					return ok;
+				}
+				case '"': {
+					std::string value;
+					if (!parseString(value)) {
+						return false;
+					}
+					obs_data_set_string(data, name.c_str(), value.c_str());
+					return true;
+				}
+				case 't':
+					if (!consumeLiteral("true")) {
+						return false;
+					}
+					obs_data_set_bool(data, name.c_str(), true);
+					return true;
+				case 'f':
+					if (!consumeLiteral("false")) {
+						return false;
+					}
+					obs_data_set_bool(data, name.c_str(), false);
+					return true;
+				case 'n':
+					return consumeLiteral("null");
+				default:
+					return parseNumber(data, name);
+			}
+		}
+
+		bool parseObject(obs_data_t* data)
+		{
+			if (!consume('{')) {
+				return false;
+			}
+			if (consume('}')) {
+				return true;
+			}
+
+			std::string name;
+			do {
+				skipWhitespace();
+				if (!parseString(name) || !consume(':') || !parseValue(data, name)) {
+					return false;
+				}
+			} while (consume(','));
+
+			return consume('}');
+		}
+
+		const char* _pos;
+	};
+}
+
+// --- JSON writer ---
+
+static void writeIndent(std::string& out, int depth)
+{
+	out += '\n';
+	out.append((size_t)depth * 4, ' ');
+}
+
+static void writeString(std::string& out, const std::string& value)
+{
+	out += '"';
+	for (unsigned char c : value) {
+		switch (c) {
+			case '"': out += "\\\""; break;
+			case '\\': out += "\\\\"; break;
+			case '\b': out += "\\b"; break;
+			case '\f': out += "\\f"; break;
+			case '\n': out += "\\n"; break;
+			case '\r': out += "\\r"; break;
+			case '\t': out += "\\t"; break;
+			default:
+				if (c < 0x20) {
+					char escaped[8];
+					snprintf(escaped, sizeof(escaped), "\\u%04X", c);
+					out += escaped;
+				} else {
+					out += (char)c;
+				}
+		}
+	}
+	out += '"';
+}
+
+static void writeDouble(std::string& out, double value)
+{
+	if (!std::isfinite(value)) {
+		out += "0.0";
+		return;
+	}
+
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "%.17g", value);
+	out += buffer;
+	if (!strpbrk(buffer, ".eE")) {
+		out += ".0";
+	}
+}
+
+static bool hasValue(obs_data_item_t* item)
+{
+	switch (item->type) {
+		case OBS_DATA_NULL:
+			return false;
+		case OBS_DATA_OBJECT:
+			return item->objValue != nullptr;
+		case OBS_DATA_ARRAY:
+			return item->arrayValue != nullptr;
+		default:
+			return true;
+	}
+}
+
+static void writeObject(std::string& out, obs_data_t* data, int depth);
+
+static void writeArray(std::string& out, obs_data_array_t* array, int depth)
+{
+	if (array->objects.empty()) {
+		out += "[]";
+		return;
+	}
+
+	out += '[';
+	for (size_t i = 0; i < array->objects.size(); i++) {
+		if (i > 0) {
+			out += ',';
+		}
+		writeIndent(out, depth + 1);
+		writeObject(out, array->objects[i], depth + 1);
+	}
+	writeIndent(out, depth);
+	out += ']';
+}
+
+static void writeObject(std::string& out, obs_data_t* data, int depth)
+{
+	bool empty = true;
+	for (obs_data_item_t* item : data->items) {
+		if (!hasValue(item)) {
+			continue;
+		}
+
+		out += (empty ? "{" : ",");
+		empty = false;
+		writeIndent(out, depth + 1);
+		writeString(out, item->name);
+		out += ": ";
+
+		switch (item->type) {
+			case OBS_DATA_STRING:
+				writeString(out, item->stringValue);
+				break;
+			case OBS_DATA_NUMBER:
+				if (item->numType == OBS_DATA_NUM_DOUBLE) {
+					writeDouble(out, item->doubleValue);
+				} else {
+					out += std::to_string(item->intValue);
+				}
+				break;
+			case OBS_DATA_BOOLEAN:
+				out += (item->boolValue ? "true" : "false");
+				break;
+			case OBS_DATA_OBJECT:
+				writeObject(out, item->objValue, depth + 1);
+				break;
+			case OBS_DATA_ARRAY:
+				writeArray(out, item->arrayValue, depth + 1);
+				break;
+			default:
+				break;
+		}
+	}
+
+	if (empty) {
+		out += "{}";
+		return;
+	}
+	writeIndent(out, depth);
+	out += '}';
+}
+
+// --- obs_data ---
+
+obs_data_t* obs_data_create()
+{
+	obs_data_t* data = new obs_data_t();
+	data->refs = 1;
+	return data;
+}
+
+obs_data_t* obs_data_create_from_json(const char* json_string)
+{
+	if (!json_string) {
+		return nullptr;
+	}
+
+	JsonReader reader(json_string);
+	obs_data_t* data = reader.parseDocument();
+	if (!data) {
+		blog(LOG_ERROR, "obs-data.c: [obs_data_create_from_json] Failed reading json string");
+	}
+	return data;
+}
+
+void obs_data_addref(obs_data_t* data)
+{
+	if (data) {
+		++data->refs;
+	}
+}
+
+void obs_data_release(obs_data_t* data)
+{
+	if (!data || --data->refs > 0) {
+		return;
+	}
+
+	for (obs_data_item_t* item : data->items) {
+		item->parent = nullptr;
+		itemRelease(item);
+	}
+	delete data;
+}
+
+const char* obs_data_get_json(obs_data_t* data)
+{
+	if (!data) {
+		return nullptr;
+	}
+
+	data->json.clear();
+	writeObject(data->json, data, 0);
+	return data->json.c_str();
+}
+
+void obs_data_apply(obs_data_t* target, obs_data_t* apply_data)
+{
+	if (!target || !apply_data || target == apply_data) {
+		return;
+	}
+
+	for (obs_data_item_t* item : apply_data->items) {
+		const char* name = item->name.c_str();
+		switch (item->type) {
+			case OBS_DATA_STRING:
+				obs_data_set_string(target, name, item->stringValue.c_str());
+				break;
+			case OBS_DATA_NUMBER:
+				if (item->numType == OBS_DATA_NUM_DOUBLE) {
+					obs_data_set_double(target, name, item->doubleValue);
+				} else {
+					obs_data_set_int(target, name, item->intValue);
+				}
+				break;
+			case OBS_DATA_BOOLEAN:
+				obs_data_set_bool(target, name, item->boolValue);
+				break;
+			case OBS_DATA_OBJECT:
+				if (item->objValue) {
+					obs_data_set_obj(target, name, item->objValue);
+				}
+				break;
+			case OBS_DATA_ARRAY:
+				if (item->arrayValue) {
+					obs_data_set_array(target, name, item->arrayValue);
+				}
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+void obs_data_set_string(obs_data_t* data, const char* name, const char* val)
+{
+	obs_data_item_t* item = prepareItem(data, name);
+	if (item) {
+		item->type = OBS_DATA_STRING;
+		item->stringValue = (val ? val : "");
+	}
+}
+
+void obs_data_set_int(obs_data_t* data, const char* name, long long val)
+{
+	obs_data_item_t* item = prepareItem(data, name);
+	if (item) {
+		item->type = OBS_DATA_NUMBER;
+		item->numType = OBS_DATA_NUM_INT;
+		item->intValue = val;
+		item->doubleValue = (double)val;
+	}
+}
+
+void obs_data_set_double(obs_data_t* data, const char* name, double val)
+{
+	obs_data_item_t* item = prepareItem(data, name);
+	if (item) {
+		item->type = OBS_DATA_NUMBER;
+		item->numType = OBS_DATA_NUM_DOUBLE;
+		item->doubleValue = val;
+		item->intValue = (long long)val;
+	}
+}
+
+void obs_data_set_bool(obs_data_t* data, const char* name, bool val)
+{
+	obs_data_item_t* item = prepareItem(data, name);
+	if (item) {
+		item->type = OBS_DATA_BOOLEAN;
+		item->boolValue = val;
+	}
+}
+
+void obs_data_set_obj(obs_data_t* data, const char* name, obs_data_t* obj)
+{
+	obs_data_item_t* item = prepareItem(data, name);
+	if (item) {
+		obs_data_addref(obj);
+		item->type = OBS_DATA_OBJECT;
+		item->objValue = obj;
+	}
+}
+
+void obs_data_set_array(obs_data_t* data, const char* name, obs_data_array_t* array)
+{
+	obs_data_item_t* item = prepareItem(data, name);
+	if (item) {
+		obs_data_array_addref(array);
+		item->type = OBS_DATA_ARRAY;
+		item->arrayValue = array;
+	}
+}
+
+const char* obs_data_get_string(obs_data_t* data, const char* name)
+{
+	return obs_data_item_get_string(findItem(data, name));
+}
+
+long long obs_data_get_int(obs_data_t* data, const char* name)
+{
+	return obs_data_item_get_int(findItem(data, name));
+}
+
+double obs_data_get_double(obs_data_t* data, const char* name)
+{
+	return obs_data_item_get_double(findItem(data, name));
+}
+
+bool obs_data_get_bool(obs_data_t* data, const char* name)
+{
+	return obs_data_item_get_bool(findItem(data, name));
+}
+
+obs_data_t* obs_data_get_obj(obs_data_t* data, const char* name)
+{
+	obs_data_item_t* item = findItem(data, name);
+	if (!item || item->type != OBS_DATA_OBJECT) {
+		return nullptr;
+	}
+
+	obs_data_addref(item->objValue);
+	return item->objValue;
+}
+
+obs_data_array_t* obs_data_get_array(obs_data_t* data, const char* name)
+{
+	obs_data_item_t* item = findItem(data, name);
+	if (!item || item->type != OBS_DATA_ARRAY) {
+		return nullptr;
+	}
+
+	obs_data_array_addref(item->arrayValue);
+	return item->arrayValue;
+}
+
+bool obs_data_has_user_value(obs_data_t* data, const char* name)
+{
+	obs_data_item_t* item = findItem(data, name);
+	return item && hasValue(item);
+}
+
+// --- obs_data_array ---
+
+obs_data_array_t* obs_data_array_create()
+{
+	obs_data_array_t* array = new obs_data_array_t();
+	array->refs = 1;
+	return array;
+}
+
+void obs_data_array_addref(obs_data_array_t* array)
+{
+	if (array) {
+		++array->refs;
+	}
+}
+
+void obs_data_array_release(obs_data_array_t* array)
+{
+	if (!array || --array->refs > 0) {
+		return;
+	}
+
+	for (obs_data_t* obj : array->objects) {
+		obs_data_release(obj);
+	}
+	delete array;
+}
+
+size_t obs_data_array_count(obs_data_array_t* array)
+{
+	return array ? array->objects.size() : 0;
+}
+
+obs_data_t* obs_data_array_item(obs_data_array_t* array, size_t idx)
+{
+	if (!array || idx >= array->objects.size()) {
+		return nullptr;
+	}
+
+	obs_data_t* obj = array->objects[idx];
+	obs_data_addref(obj);
+	return obj;
+}
+
+size_t obs_data_array_push_back(obs_data_array_t* array, obs_data_t* obj)
+{
+	if (!array || !obj) {
+		return 0;
+	}
+
+	obs_data_addref(obj);
+	array->objects.push_back(obj);
+	return array->objects.size() - 1;
+}
+
+void obs_data_array_insert(obs_data_array_t* array, size_t idx, obs_data_t* obj)
+{
+	if (!array || !obj) {
+		return;
+	}
+
+	obs_data_addref(obj);
+	idx = std::min(idx, array->objects.size());
+	array->objects.insert(array->objects.begin() + idx, obj);
+}
+
+// --- obs_data_item ---
+
+obs_data_item_t* obs_data_first(obs_data_t* data)
+{
+	if (!data || data->items.empty()) {
+		return nullptr;
+	}
+
+	obs_data_item_t* item = data->items.front();
+	++item->refs;
+	return item;
+}
+
+obs_data_item_t* obs_data_item_byname(obs_data_t* data, const char* name)
+{
+	obs_data_item_t* item = findItem(data, name);
+	if (item) {
+		++item->refs;
+	}
+	return item;
+}
+
+bool obs_data_item_next(obs_data_item_t** item)
+{
+	if (!item || !*item) {
+		return false;
+	}
+
+	obs_data_item_t* current = *item;
+	obs_data_t* parent = current->parent;
+	obs_data_item_t* next = nullptr;
+	if (parent && current->index + 1 < parent->items.size()) {
+		next = parent->items[current->index + 1];
+		++next->refs;
+	}
+
+	itemRelease(current);
+	*item = next;
+	return next != nullptr;
+}
+
+void obs_data_item_release(obs_data_item_t** item)
+{
+	if (item && *item) {
+		itemRelease(*item);
+		*item = nullptr;
+	}
+}
+
+const char* obs_data_item_get_name(obs_data_item_t* item)
+{
+	return item ? item->name.c_str() : nullptr;
+}
+
+bool obs_data_item_has_user_value(obs_data_item_t* item)
+{
+	return item && hasValue(item);
+}
+
+enum obs_data_type obs_data_item_gettype(obs_data_item_t* item)
+{
+	return item ? item->type : OBS_DATA_NULL;
+}
+
+enum obs_data_number_type obs_data_item_numtype(obs_data_item_t* item)
+{
+	if (!item || item->type != OBS_DATA_NUMBER) {
+		return OBS_DATA_NUM_INVALID;
+	}
+	return item->numType;
+}
+
+const char* obs_data_item_get_string(obs_data_item_t* item)
+{
+	if (!item || item->type != OBS_DATA_STRING) {
+		return "";
+	}
+	return item->stringValue.c_str();
+}
+
+long long obs_data_item_get_int(obs_data_item_t* item)
+{
+	if (!item || item->type != OBS_DATA_NUMBER) {
+		return 0;
+	}
+	return item->intValue;
+}
+
+double obs_data_item_get_double(obs_data_item_t* item)
+{
+	if (!item || item->type != OBS_DATA_NUMBER) {
+		return 0.0;
+	}
+	return item->doubleValue;
+}
+
+bool obs_data_item_get_bool(obs_data_item_t* item)
+{
+	if (!item || item->type != OBS_DATA_BOOLEAN) {
+		return false;
+	}
+	return item->boolValue;
+}
+
+obs_data_t* obs_data_item_get_obj(obs_data_item_t* item)
+{
+	if (!item || item->type != OBS_DATA_OBJECT) {
+		return nullptr;
+	}
+
+	obs_data_addref(item->objValue);
+	return item->objValue;
+}
+
+obs_data_array_t* obs_data_item_get_array(obs_data_item_t* item)
+{
+	if (!item || item->type != OBS_DATA_ARRAY) {
+		return nullptr;
+	}
+
+	obs_data_array_addref(item->arrayValue);
+	return item->arrayValue;
+}
@@ -0,0 +1,552 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include <obs-frontend-api.h>
+#include <util/bmem.h>
+
+#include "headless-internal.h"
+
+// Frontend state: scene and transition lists, program/preview selection,
+// output toggles, profiles and configuration. State changes emit the same
+// frontend events as OBS, synchronously on the calling thread.
+
+#define DEFAULT_TRANSITION_DURATION 300
+#define DEFAULT_PROFILE "Untitled"
+#define DEFAULT_SCENE_COLLECTION "Untitled"
+
+namespace {
+	typedef std::pair<obs_frontend_event_cb, void*> EventCallback;
+
+	struct FrontendState {
+		std::vector<obs_source_t*> scenes;
+		std::vector<obs_source_t*> transitions;
+		obs_source_t* currentScene = nullptr;
+		obs_source_t* previewScene = nullptr;
+		obs_source_t* currentTransition = nullptr;
+		int transitionDuration = DEFAULT_TRANSITION_DURATION;
+		bool studioMode = false;
+		bool recordingPaused = false;
+
+		obs_output_t* streamingOutput = nullptr;
+		obs_output_t* recordingOutput = nullptr;
+		obs_output_t* replayBufferOutput = nullptr;
+		obs_service_t* streamingService = nullptr;
+
+		std::vector<std::string> profiles = { DEFAULT_PROFILE };
+		std::vector<std::string> sceneCollections = { DEFAULT_SCENE_COLLECTION };
+		std::string currentProfile = DEFAULT_PROFILE;
+		std::string currentSceneCollection = DEFAULT_SCENE_COLLECTION;
+
+		std::vector<EventCallback> callbacks;
+		std::vector<obs_frontend_translate_ui_cb> translations;
+
+		config_t globalConfig;
+		config_t profileConfig;
+	};
+
+	FrontendState& state()
+	{
+		static FrontendState frontendState;
+		return frontendState;
+	}
+
+	// Replaces a held reference with a new one
+	void assignSource(obs_source_t*& slot, obs_source_t* source)
+	{
+		obs_source_addref(source);
+		obs_source_release(slot);
+		slot = source;
+	}
+
+	// Reads a held reference and adds one for the caller
+	obs_source_t* sourceRef(obs_source_t* const& slot)
+	{
+		std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+		obs_source_addref(slot);
+		return slot;
+	}
+
+	obs_output_t* outputRef(obs_output_t* const& slot)
+	{
+		std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+		obs_output_addref(slot);
+		return slot;
+	}
+
+	void copySourceList(const std::vector<obs_source_t*>& list,
+		struct obs_frontend_source_list* sources)
+	{
+		std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+		for (obs_source_t* source : list) {
+			obs_source_addref(source);
+			da_push_back(sources->sources, &source);
+		}
+	}
+
+	// Packs the names in a single allocation, released with bfree()
+	char** copyStringList(const std::vector<std::string>& list)
+	{
+		size_t size = (list.size() + 1) * sizeof(char*);
+		for (const std::string& entry : list) {
+			size += entry.size() + 1;
+		}
+
+		char** result = (char**)bmalloc(size);
+		char* strings = (char*)(result + list.size() + 1);
+		for (size_t i = 0; i < list.size(); i++) {
+			result[i] = strings;
+			memcpy(strings, list[i].c_str(), list[i].size() + 1);
+			strings += list[i].size() + 1;
+		}
+		result[list.size()] = nullptr;
+		return result;
+	}
+
+	bool startOutput(obs_output_t* output, enum obs_frontend_event starting,
+		enum obs_frontend_event started)
+	{
+		if (!output || obs_output_active(output)) {
+			return false;
+		}
+
+		headless::emitFrontendEvent(starting);
+		obs_output_start(output);
+		headless::emitFrontendEvent(started);
+		return true;
+	}
+
+	bool stopOutput(obs_output_t* output, enum obs_frontend_event stopping,
+		enum obs_frontend_event stopped)
+	{
+		if (!output || !obs_output_active(output)) {
+			return false;
+		}
+
+		headless::emitFrontendEvent(stopping);
+		obs_output_stop(output);
+		headless::emitFrontendEvent(stopped);
+		return true;
+	}
+}
+
+void headless::emitFrontendEvent(enum obs_frontend_event event)
+{
+	std::vector<EventCallback> callbacks;
+	{
+		std::lock_guard<std::recursive_mutex> lock(graphMutex());
+		callbacks = state().callbacks;
+	}
+
+	for (const EventCallback& callback : callbacks) {
+		callback.first(event, callback.second);
+	}
+}
+
+void headless::setFrontendScenes(const std::vector<obs_source_t*>& scenes,
+	const std::vector<obs_source_t*>& transitions)
+{
+	std::lock_guard<std::recursive_mutex> lock(graphMutex());
+	FrontendState& frontend = state();
+
+	frontend.scenes = scenes;
+	frontend.transitions = transitions;
+	assignSource(frontend.currentScene, scenes.empty() ? nullptr : scenes.front());
+	assignSource(frontend.currentTransition, transitions.empty() ? nullptr : transitions.front());
+
+	if (!frontend.streamingOutput) {
+		frontend.streamingOutput = createOutput("rtmp_output", "simple_stream",
+			OBS_OUTPUT_AV | OBS_OUTPUT_ENCODED | OBS_OUTPUT_SERVICE);
+		frontend.recordingOutput = createOutput("ffmpeg_muxer", "simple_file_output",
+			OBS_OUTPUT_AV | OBS_OUTPUT_ENCODED);
+		frontend.replayBufferOutput = createOutput("replay_buffer", "ReplayBuffer",
+			OBS_OUTPUT_AV | OBS_OUTPUT_ENCODED);
+		frontend.streamingService = obs_service_create("rtmp_common", "default_service",
+			nullptr, nullptr);
+	}
+
+	config_set_default_string(&frontend.profileConfig, "Output", "Mode", "Simple");
+	config_set_default_string(&frontend.profileConfig, "Output", "FilenameFormatting",
+		"%CCYY-%MM-%DD %hh-%mm-%ss");
+	config_set_default_string(&frontend.profileConfig, "SimpleOutput", "FilePath", "/tmp");
+	config_set_default_string(&frontend.profileConfig, "AdvOut", "RecFilePath", "/tmp");
+	config_set_default_bool(&frontend.profileConfig, "SimpleOutput", "RecRB", true);
+	config_set_default_bool(&frontend.profileConfig, "AdvOut", "RecRB", true);
+}
+
+void headless::clearFrontend()
+{
+	std::vector<obs_source_t*> released;
+	{
+		std::lock_guard<std::recursive_mutex> lock(graphMutex());
+		FrontendState& frontend = state();
+
+		released.swap(frontend.scenes);
+		released.insert(released.end(), frontend.transitions.begin(), frontend.transitions.end());
+		frontend.transitions.clear();
+		assignSource(frontend.currentScene, nullptr);
+		assignSource(frontend.previewScene, nullptr);
+		assignSource(frontend.currentTransition, nullptr);
+
+		obs_output_release(frontend.streamingOutput);
+		obs_output_release(frontend.recordingOutput);
+		obs_output_release(frontend.replayBufferOutput);
+		obs_service_release(frontend.streamingService);
+		frontend.streamingOutput = nullptr;
+		frontend.recordingOutput = nullptr;
+		frontend.replayBufferOutput = nullptr;
+		frontend.streamingService = nullptr;
+
+		frontend.studioMode = false;
+		frontend.recordingPaused = false;
+		frontend.transitionDuration = DEFAULT_TRANSITION_DURATION;
+		frontend.callbacks.clear();
+		frontend.translations.clear();
+	}
+
+	for (obs_source_t* source : released) {
+		obs_source_release(source);
+	}
+}
+
+bool headless::recordingPaused()
+{
+	std::lock_guard<std::recursive_mutex> lock(graphMutex());
+	return state().recordingPaused;
+}
+
+void headless::pauseRecording(bool pause)
+{
+	{
+		std::lock_guard<std::recursive_mutex> lock(graphMutex());
+		FrontendState& frontend = state();
+		if (!obs_output_active(frontend.recordingOutput) || frontend.recordingPaused == pause) {
+			return;
+		}
+		frontend.recordingPaused = pause;
+	}
+
+	emitFrontendEvent(pause ? OBS_FRONTEND_EVENT_RECORDING_PAUSED
+		: OBS_FRONTEND_EVENT_RECORDING_UNPAUSED);
+}
+
+// --- Callbacks ---
+
+void obs_frontend_add_event_callback(obs_frontend_event_cb callback, void* private_data)
+{
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	state().callbacks.push_back(EventCallback(callback, private_data));
+}
+
+void obs_frontend_remove_event_callback(obs_frontend_event_cb callback, void* private_data)
+{
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	std::vector<EventCallback>& callbacks = state().callbacks;
+	callbacks.erase(std::remove(callbacks.begin(), callbacks.end(),
+		EventCallback(callback, private_data)), callbacks.end());
+}
+
+void obs_frontend_push_ui_translation(obs_frontend_translate_ui_cb translate)
+{
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	state().translations.push_back(translate);
+}
+
+void obs_frontend_pop_ui_translation(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	if (!state().translations.empty()) {
+		state().translations.pop_back();
+	}
+}
+
+void* obs_frontend_get_main_window(void)
+{
+	return nullptr;
+}
+
+// --- Scenes ---
+
+void obs_frontend_get_scenes(struct obs_frontend_source_list* sources)
+{
+	copySourceList(state().scenes, sources);
+}
+
+obs_source_t* obs_frontend_get_current_scene(void)
+{
+	return sourceRef(state().currentScene);
+}
+
+void obs_frontend_set_current_scene(obs_source_t* scene)
+{
+	{
+		std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+		assignSource(state().currentScene, scene);
+	}
+	headless::emitFrontendEvent(OBS_FRONTEND_EVENT_SCENE_CHANGED);
+}
+
+obs_source_t* obs_frontend_get_current_preview_scene(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	if (!state().studioMode) {
+		return nullptr;
+	}
+	return sourceRef(state().previewScene);
+}
+
+void obs_frontend_set_current_preview_scene(obs_source_t* scene)
+{
+	{
+		std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+		if (!state().studioMode) {
+			return;
+		}
+		assignSource(state().previewScene, scene);
+	}
+	headless::emitFrontendEvent(OBS_FRONTEND_EVENT_PREVIEW_SCENE_CHANGED);
+}
+
+bool obs_frontend_preview_program_mode_active(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	return state().studioMode;
+}
+
+void obs_frontend_set_preview_program_mode(bool enable)
+{
+	{
+		std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+		FrontendState& frontend = state();
+		if (frontend.studioMode == enable) {
+			return;
+		}
+
+		frontend.studioMode = enable;
+		assignSource(frontend.previewScene, enable ? frontend.currentScene : nullptr);
+	}
+
+	headless::emitFrontendEvent(enable ? OBS_FRONTEND_EVENT_STUDIO_MODE_ENABLED
+		: OBS_FRONTEND_EVENT_STUDIO_MODE_DISABLED);
+}
+
+void obs_frontend_preview_program_trigger_transition(void)
+{
+	{
+		std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+		FrontendState& frontend = state();
+		if (!frontend.studioMode) {
+			return;
+		}
+		assignSource(frontend.currentScene, frontend.previewScene);
+	}
+	headless::emitFrontendEvent(OBS_FRONTEND_EVENT_SCENE_CHANGED);
+}
+
+// --- Transitions ---
+
+void obs_frontend_get_transitions(struct obs_frontend_source_list* sources)
+{
+	copySourceList(state().transitions, sources);
+}
+
+obs_source_t* obs_frontend_get_current_transition(void)
+{
+	return sourceRef(state().currentTransition);
+}
+
+void obs_frontend_set_current_transition(obs_source_t* transition)
+{
+	{
+		std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+		assignSource(state().currentTransition, transition);
+	}
+	headless::emitFrontendEvent(OBS_FRONTEND_EVENT_TRANSITION_CHANGED);
+}
+
+int obs_frontend_get_transition_duration(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	return state().transitionDuration;
+}
+
+void obs_frontend_set_transition_duration(int duration)
+{
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	state().transitionDuration = duration;
+}
+
+// --- Outputs ---
+
+bool obs_frontend_streaming_active(void)
+{
+	return obs_output_active(state().streamingOutput);
+}
+
+void obs_frontend_streaming_start(void)
+{
+	startOutput(state().streamingOutput,
+		OBS_FRONTEND_EVENT_STREAMING_STARTING, OBS_FRONTEND_EVENT_STREAMING_STARTED);
+}
+
+void obs_frontend_streaming_stop(void)
+{
+	stopOutput(state().streamingOutput,
+		OBS_FRONTEND_EVENT_STREAMING_STOPPING, OBS_FRONTEND_EVENT_STREAMING_STOPPED);
+}
+
+bool obs_frontend_recording_active(void)
+{
+	return obs_output_active(state().recordingOutput);
+}
+
+void obs_frontend_recording_start(void)
+{
+	startOutput(state().recordingOutput,
+		OBS_FRONTEND_EVENT_RECORDING_STARTING, OBS_FRONTEND_EVENT_RECORDING_STARTED);
+}
+
+void obs_frontend_recording_stop(void)
+{
+	if (stopOutput(state().recordingOutput,
+		OBS_FRONTEND_EVENT_RECORDING_STOPPING, OBS_FRONTEND_EVENT_RECORDING_STOPPED))
+	{
+		std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+		state().recordingPaused = false;
+	}
+}
+
+bool obs_frontend_replay_buffer_active(void)
+{
+	return obs_output_active(state().replayBufferOutput);
+}
+
+void obs_frontend_replay_buffer_start(void)
+{
+	startOutput(state().replayBufferOutput,
+		OBS_FRONTEND_EVENT_REPLAY_BUFFER_STARTING, OBS_FRONTEND_EVENT_REPLAY_BUFFER_STARTED);
+}
+
+void obs_frontend_replay_buffer_stop(void)
+{
+	stopOutput(state().replayBufferOutput,
+		OBS_FRONTEND_EVENT_REPLAY_BUFFER_STOPPING, OBS_FRONTEND_EVENT_REPLAY_BUFFER_STOPPED);
+}
+
+obs_output_t* obs_frontend_get_streaming_output(void)
+{
+	return outputRef(state().streamingOutput);
+}
+
+obs_output_t* obs_frontend_get_recording_output(void)
+{
+	return outputRef(state().recordingOutput);
+}
+
+obs_output_t* obs_frontend_get_replay_buffer_output(void)
+{
+	return outputRef(state().replayBufferOutput);
+}
+
+obs_service_t* obs_frontend_get_streaming_service(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	return state().streamingService;
+}
+
+void obs_frontend_set_streaming_service(obs_service_t* service)
+{
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	FrontendState& frontend = state();
+	obs_service_addref(service);
+	obs_service_release(frontend.streamingService);
+	frontend.streamingService = service;
+}
+
+void obs_frontend_save_streaming_service(void)
+{
+}
+
+// --- Profiles and scene collections ---
+
+char** obs_frontend_get_profiles(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	return copyStringList(state().profiles);
+}
+
+char* obs_frontend_get_current_profile(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	return bstrdup(state().currentProfile.c_str());
+}
+
+void obs_frontend_set_current_profile(const char* profile)
+{
+	{
+		std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+		FrontendState& frontend = state();
+		if (!profile || std::find(frontend.profiles.begin(), frontend.profiles.end(),
+			profile) == frontend.profiles.end())
+		{
+			return;
+		}
+		frontend.currentProfile = profile;
+	}
+	headless::emitFrontendEvent(OBS_FRONTEND_EVENT_PROFILE_CHANGED);
+}
+
+char** obs_frontend_get_scene_collections(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	return copyStringList(state().sceneCollections);
+}
+
+char* obs_frontend_get_current_scene_collection(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	return bstrdup(state().currentSceneCollection.c_str());
+}
+
+void obs_frontend_set_current_scene_collection(const char* collection)
+{
+	{
+		std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+		FrontendState& frontend = state();
+		if (!collection || std::find(frontend.sceneCollections.begin(),
+			frontend.sceneCollections.end(), collection) == frontend.sceneCollections.end())
+		{
+			return;
+		}
+		frontend.currentSceneCollection = collection;
+	}
+	headless::emitFrontendEvent(OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGED);
+}
+
+config_t* obs_frontend_get_global_config(void)
+{
+	return &state().globalConfig;
+}
+
+config_t* obs_frontend_get_profile_config(void)
+{
+	return &state().profileConfig;
+}
@@ -0,0 +1,554 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <vector>
+
+#include <obs.h>
+#include <media-io/video-io.h>
+#include <util/platform.h>
+
+#include "headless-internal.h"
+
+// Outputs, services, hotkeys, video statistics and the graphics subsystem.
+// Active outputs report synthetic statistics derived from their uptime;
+// rendering is a no-op and stage surfaces map to cleared memory.
+
+#define VIDEO_WIDTH 1920
+#define VIDEO_HEIGHT 1080
+#define VIDEO_FPS 30
+#define OUTPUT_BITRATE_KBPS 2500
+
+struct video_output {
+	uint64_t startTime;
+};
+
+struct gs_texture_render {
+	uint32_t width;
+	uint32_t height;
+};
+
+struct gs_stage_surface {
+	uint32_t width;
+	uint32_t height;
+	std::vector<uint8_t> pixels;
+};
+
+namespace {
+	std::vector<obs_output_t*> outputs;
+
+	video_output* mainVideo()
+	{
+		static video_output video = { os_gettime_ns() };
+		return &video;
+	}
+
+	uint64_t outputUptime(const obs_output_t* output)
+	{
+		if (!output || !output->active) {
+			return 0;
+		}
+		return os_gettime_ns() - output->startTime;
+	}
+}
+
+obs_output_t* headless::createOutput(const char* id, const char* name, uint32_t flags)
+{
+	obs_output_t* output = new obs_output_t();
+	output->refs = 1;
+	output->id = id;
+	output->name = name;
+	output->settings = obs_data_create();
+	output->flags = flags;
+	output->active = false;
+	output->startTime = 0;
+
+	std::lock_guard<std::recursive_mutex> lock(graphMutex());
+	outputs.push_back(output);
+	obs_output_addref(output);
+	return output;
+}
+
+void headless::clearOutputs()
+{
+	std::vector<obs_output_t*> released;
+	{
+		std::lock_guard<std::recursive_mutex> lock(graphMutex());
+		released.swap(outputs);
+	}
+
+	for (obs_output_t* output : released) {
+		obs_output_release(output);
+	}
+}
+
+// --- obs_output ---
+
+void obs_output_addref(obs_output_t* output)
+{
+	if (output) {
+		++output->refs;
+	}
+}
+
+void obs_output_release(obs_output_t* output)
+{
+	if (output && --output->refs == 0) {
+		obs_data_release(output->settings);
+		delete output;
+	}
+}
+
+obs_output_t* obs_get_output_by_name(const char* name)
+{
+	if (!name) {
+		return nullptr;
+	}
+
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	for (obs_output_t* output : outputs) {
+		if (output->name == name) {
+			obs_output_addref(output);
+			return output;
+		}
+	}
+	return nullptr;
+}
+
+void obs_enum_outputs(bool (*enum_proc)(void*, obs_output_t*), void* param)
+{
+	std::vector<obs_output_t*> snapshot;
+	{
+		std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+		snapshot = outputs;
+		for (obs_output_t* output : snapshot) {
+			obs_output_addref(output);
+		}
+	}
+
+	bool proceed = true;
+	for (obs_output_t* output : snapshot) {
+		if (proceed) {
+			proceed = enum_proc(param, output);
+		}
+		obs_output_release(output);
+	}
+}
+
+const char* obs_output_get_name(const obs_output_t* output)
+{
+	return output ? output->name.c_str() : nullptr;
+}
+
+const char* obs_output_get_id(const obs_output_t* output)
+{
+	return output ? output->id.c_str() : nullptr;
+}
+
+obs_data_t* obs_output_get_settings(const obs_output_t* output)
+{
+	if (!output) {
+		return nullptr;
+	}
+
+	obs_data_addref(output->settings);
+	return output->settings;
+}
+
+uint32_t obs_output_get_flags(const obs_output_t* output)
+{
+	return output ? output->flags : 0;
+}
+
+bool obs_output_start(obs_output_t* output)
+{
+	if (!output) {
+		return false;
+	}
+
+	if (!output->active) {
+		output->startTime = os_gettime_ns();
+		output->active = true;
+	}
+	return true;
+}
+
+void obs_output_stop(obs_output_t* output)
+{
+	if (output) {
+		output->active = false;
+	}
+}
+
+void obs_output_force_stop(obs_output_t* output)
+{
+	obs_output_stop(output);
+}
+
+bool obs_output_active(const obs_output_t* output)
+{
+	return output ? output->active : false;
+}
+
+bool obs_output_reconnecting(const obs_output_t* output)
+{
+	UNUSED_PARAMETER(output);
+	return false;
+}
+
+const char* obs_output_get_last_error(obs_output_t* output)
+{
+	UNUSED_PARAMETER(output);
+	return nullptr;
+}
+
+uint32_t obs_output_get_width(const obs_output_t* output)
+{
+	return output ? VIDEO_WIDTH : 0;
+}
+
+uint32_t obs_output_get_height(const obs_output_t* output)
+{
+	return output ? VIDEO_HEIGHT : 0;
+}
+
+float obs_output_get_congestion(obs_output_t* output)
+{
+	UNUSED_PARAMETER(output);
+	return 0.0f;
+}
+
+int obs_output_get_frames_dropped(const obs_output_t* output)
+{
+	UNUSED_PARAMETER(output);
+	return 0;
+}
+
+int obs_output_get_total_frames(const obs_output_t* output)
+{
+	return (int)(outputUptime(output) * VIDEO_FPS / 1000000000ULL);
+}
+
+uint64_t obs_output_get_total_bytes(const obs_output_t* output)
+{
+	return outputUptime(output) / 1000000ULL * OUTPUT_BITRATE_KBPS / 8;
+}
+
+proc_handler_t* obs_output_get_proc_handler(const obs_output_t* output)
+{
+	UNUSED_PARAMETER(output);
+	return nullptr;
+}
+
+video_t* obs_output_video(const obs_output_t* output)
+{
+	return output ? mainVideo() : nullptr;
+}
+
+void obs_output_output_caption_text1(obs_output_t* output, const char* text)
+{
+	UNUSED_PARAMETER(output);
+	UNUSED_PARAMETER(text);
+}
+
+// --- obs_service ---
+
+obs_service_t* obs_service_create(const char* id, const char* name, obs_data_t* settings,
+	obs_data_t* hotkey_data)
+{
+	UNUSED_PARAMETER(hotkey_data);
+
+	if (!id) {
+		return nullptr;
+	}
+
+	obs_service_t* service = new obs_service_t();
+	service->refs = 1;
+	service->id = id;
+	service->name = (name ? name : "");
+	if (settings) {
+		obs_data_addref(settings);
+		service->settings = settings;
+	} else {
+		service->settings = obs_data_create();
+	}
+	return service;
+}
+
+void obs_service_addref(obs_service_t* service)
+{
+	if (service) {
+		++service->refs;
+	}
+}
+
+void obs_service_release(obs_service_t* service)
+{
+	if (service && --service->refs == 0) {
+		obs_data_release(service->settings);
+		delete service;
+	}
+}
+
+const char* obs_service_get_type(const obs_service_t* service)
+{
+	return service ? service->id.c_str() : nullptr;
+}
+
+obs_data_t* obs_service_get_settings(const obs_service_t* service)
+{
+	if (!service) {
+		return nullptr;
+	}
+
+	obs_data_addref(service->settings);
+	return service->settings;
+}
+
+void obs_service_update(obs_service_t* service, obs_data_t* settings)
+{
+	if (service && settings) {
+		obs_data_apply(service->settings, settings);
+	}
+}
+
+// --- Hotkeys ---
+
+void obs_enum_hotkeys(obs_hotkey_enum_func func, void* data)
+{
+	UNUSED_PARAMETER(func);
+	UNUSED_PARAMETER(data);
+}
+
+const char* obs_hotkey_get_name(const obs_hotkey_t* key)
+{
+	UNUSED_PARAMETER(key);
+	return nullptr;
+}
+
+obs_data_t* obs_hotkeys_save_output(obs_output_t* output)
+{
+	UNUSED_PARAMETER(output);
+	return obs_data_create();
+}
+
+void obs_hotkeys_load_output(obs_output_t* output, obs_data_t* hotkeys)
+{
+	UNUSED_PARAMETER(output);
+	UNUSED_PARAMETER(hotkeys);
+}
+
+obs_data_t* obs_hotkeys_save_service(obs_service_t* service)
+{
+	UNUSED_PARAMETER(service);
+	return obs_data_create();
+}
+
+// --- Video ---
+
+uint32_t obs_get_version(void)
+{
+	return LIBOBS_API_VER;
+}
+
+bool obs_get_video_info(struct obs_video_info* ovi)
+{
+	if (!ovi) {
+		return false;
+	}
+
+	*ovi = {};
+	ovi->fps_num = VIDEO_FPS;
+	ovi->fps_den = 1;
+	ovi->base_width = VIDEO_WIDTH;
+	ovi->base_height = VIDEO_HEIGHT;
+	ovi->output_width = VIDEO_WIDTH;
+	ovi->output_height = VIDEO_HEIGHT;
+	ovi->output_format = VIDEO_FORMAT_NV12;
+	ovi->colorspace = VIDEO_CS_709;
+	ovi->range = VIDEO_RANGE_PARTIAL;
+	ovi->scale_type = OBS_SCALE_BICUBIC;
+	return true;
+}
+
+video_t* obs_get_video(void)
+{
+	return mainVideo();
+}
+
+double obs_get_active_fps(void)
+{
+	return (double)VIDEO_FPS;
+}
+
+uint64_t obs_get_average_frame_time_ns(void)
+{
+	return 1000000ULL;
+}
+
+uint32_t obs_get_total_frames(void)
+{
+	return video_output_get_total_frames(mainVideo());
+}
+
+uint32_t obs_get_lagged_frames(void)
+{
+	return 0;
+}
+
+uint64_t video_output_get_frame_time(const video_t* video)
+{
+	UNUSED_PARAMETER(video);
+	return 1000000000ULL / VIDEO_FPS;
+}
+
+uint32_t video_output_get_skipped_frames(const video_t* video)
+{
+	UNUSED_PARAMETER(video);
+	return 0;
+}
+
+uint32_t video_output_get_total_frames(const video_t* video)
+{
+	if (!video) {
+		return 0;
+	}
+	return (uint32_t)((os_gettime_ns() - video->startTime) * VIDEO_FPS / 1000000000ULL);
+}
+
+// --- Graphics ---
+
+void obs_enter_graphics(void)
+{
+	headless::graphMutex().lock();
+}
+
+void obs_leave_graphics(void)
+{
+	headless::graphMutex().unlock();
+}
+
+gs_texrender_t* gs_texrender_create(enum gs_color_format format, enum gs_zstencil_format zsformat)
+{
+	UNUSED_PARAMETER(format);
+	UNUSED_PARAMETER(zsformat);
+	return new gs_texrender_t();
+}
+
+void gs_texrender_destroy(gs_texrender_t* texrender)
+{
+	delete texrender;
+}
+
+bool gs_texrender_begin(gs_texrender_t* texrender, uint32_t cx, uint32_t cy)
+{
+	if (!texrender || !cx || !cy) {
+		return false;
+	}
+
+	texrender->width = cx;
+	texrender->height = cy;
+	return true;
+}
+
+void gs_texrender_end(gs_texrender_t* texrender)
+{
+	UNUSED_PARAMETER(texrender);
+}
+
+void gs_texrender_reset(gs_texrender_t* texrender)
+{
+	UNUSED_PARAMETER(texrender);
+}
+
+gs_texture_t* gs_texrender_get_texture(const gs_texrender_t* texrender)
+{
+	UNUSED_PARAMETER(texrender);
+	return nullptr;
+}
+
+gs_stagesurf_t* gs_stagesurface_create(uint32_t width, uint32_t height,
+	enum gs_color_format color_format)
+{
+	UNUSED_PARAMETER(color_format);
+
+	gs_stagesurf_t* surface = new gs_stagesurf_t();
+	surface->width = width;
+	surface->height = height;
+	surface->pixels.assign((size_t)width * height * 4, 0);
+	return surface;
+}
+
+void gs_stagesurface_destroy(gs_stagesurf_t* stagesurf)
+{
+	delete stagesurf;
+}
+
+void gs_stage_texture(gs_stagesurf_t* dst, gs_texture_t* src)
+{
+	UNUSED_PARAMETER(dst);
+	UNUSED_PARAMETER(src);
+}
+
+bool gs_stagesurface_map(gs_stagesurf_t* stagesurf, uint8_t** data, uint32_t* linesize)
+{
+	if (!stagesurf || stagesurf->pixels.empty()) {
+		return false;
+	}
+
+	*data = stagesurf->pixels.data();
+	*linesize = stagesurf->width * 4;
+	return true;
+}
+
+void gs_stagesurface_unmap(gs_stagesurf_t* stagesurf)
+{
+	UNUSED_PARAMETER(stagesurf);
+}
+
+void gs_clear(uint32_t clear_flags, const struct vec4* color, float depth, uint8_t stencil)
+{
+	UNUSED_PARAMETER(clear_flags);
+	UNUSED_PARAMETER(color);
+	UNUSED_PARAMETER(depth);
+	UNUSED_PARAMETER(stencil);
+}
+
+void gs_ortho(float left, float right, float top, float bottom, float znear, float zfar)
+{
+	UNUSED_PARAMETER(left);
+	UNUSED_PARAMETER(right);
+	UNUSED_PARAMETER(top);
+	UNUSED_PARAMETER(bottom);
+	UNUSED_PARAMETER(znear);
+	UNUSED_PARAMETER(zfar);
+}
+
+void gs_blend_state_push(void)
+{
+}
+
+void gs_blend_state_pop(void)
+{
+}
+
+void gs_blend_function(enum gs_blend_type src, enum gs_blend_type dest)
+{
+	UNUSED_PARAMETER(src);
+	UNUSED_PARAMETER(dest);
+}
@@ -0,0 +1,963 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <cstring>
+
+#include <obs.h>
+#include <obs-frontend-api.h>
+
+#include "headless-internal.h"
+
+// Sources, scenes, scene items, filters and transitions. Public sources are
+// kept in a registry for name lookups and enumeration; everything is freed
+// once its last reference is released.
+
+#define CANVAS_WIDTH 1920
+#define CANVAS_HEIGHT 1080
+
+namespace {
+	struct SourceTypeInfo {
+		const char* id;
+		const char* displayName;
+		enum obs_source_type type;
+		uint32_t outputFlags;
+	};
+
+	const SourceTypeInfo sourceTypes[] = {
+		{ "scene", "Scene", OBS_SOURCE_TYPE_SCENE, OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW | OBS_SOURCE_COMPOSITE },
+		{ "color_source", "Color Source", OBS_SOURCE_TYPE_INPUT, OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW },
+		{ "image_source", "Image", OBS_SOURCE_TYPE_INPUT, OBS_SOURCE_VIDEO },
+		{ "text_ft2_source", "Text (FreeType 2)", OBS_SOURCE_TYPE_INPUT, OBS_SOURCE_VIDEO },
+		{ "ffmpeg_source", "Media Source", OBS_SOURCE_TYPE_INPUT, OBS_SOURCE_ASYNC_VIDEO | OBS_SOURCE_AUDIO },
+		{ "pulse_input_capture", "Audio Input Capture (PulseAudio)", OBS_SOURCE_TYPE_INPUT, OBS_SOURCE_AUDIO },
+		{ "pulse_output_capture", "Audio Output Capture (PulseAudio)", OBS_SOURCE_TYPE_INPUT, OBS_SOURCE_AUDIO },
+		{ "color_filter", "Color Correction", OBS_SOURCE_TYPE_FILTER, OBS_SOURCE_VIDEO },
+		{ "crop_filter", "Crop/Pad", OBS_SOURCE_TYPE_FILTER, OBS_SOURCE_VIDEO },
+		{ "gain_filter", "Gain", OBS_SOURCE_TYPE_FILTER, OBS_SOURCE_AUDIO },
+		{ "mask_filter", "Image Mask/Blend", OBS_SOURCE_TYPE_FILTER, OBS_SOURCE_VIDEO },
+		{ "fade_transition", "Fade", OBS_SOURCE_TYPE_TRANSITION, OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW },
+		{ "cut_transition", "Cut", OBS_SOURCE_TYPE_TRANSITION, OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW }
+	};
+
+	const SourceTypeInfo* findSourceType(const char* id)
+	{
+		if (!id) {
+			return nullptr;
+		}
+
+		for (const SourceTypeInfo& info : sourceTypes) {
+			if (strcmp(info.id, id) == 0) {
+				return &info;
+			}
+		}
+		return nullptr;
+	}
+
+	bool enumSourceTypes(enum obs_source_type type, size_t idx, const char** id)
+	{
+		size_t current = 0;
+		for (const SourceTypeInfo& info : sourceTypes) {
+			if (info.type != type) {
+				continue;
+			}
+			if (current++ == idx) {
+				*id = info.id;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Public sources, without a reference: a source leaves the registry
+	// when it is destroyed
+	std::vector<obs_source_t*> registry;
+}
+
+std::recursive_mutex& headless::graphMutex()
+{
+	static std::recursive_mutex mutex;
+	return mutex;
+}
+
+obs_source_t* headless::createSource(const char* id, const char* name, enum obs_source_type type,
+	obs_data_t* settings, bool registered)
+{
+	obs_source_t* source = new obs_source_t();
+	source->refs = 1;
+	source->id = (id ? id : "");
+	source->name = (name ? name : "");
+	source->type = type;
+	source->volume = 1.0f;
+	source->muted = false;
+	source->syncOffset = 0;
+	source->scene = nullptr;
+	source->registered = registered;
+
+	if (settings) {
+		obs_data_addref(settings);
+		source->settings = settings;
+	} else {
+		source->settings = obs_data_create();
+	}
+	source->privateSettings = obs_data_create();
+
+	long long width = obs_data_get_int(source->settings, "width");
+	long long height = obs_data_get_int(source->settings, "height");
+	source->width = (width > 0 ? (uint32_t)width : CANVAS_WIDTH);
+	source->height = (height > 0 ? (uint32_t)height : CANVAS_HEIGHT);
+
+	if (type == OBS_SOURCE_TYPE_SCENE) {
+		source->scene = new obs_scene_t();
+		source->scene->source = source;
+		source->scene->nextItemId = 1;
+	}
+
+	if (registered) {
+		registerSource(source);
+	}
+	return source;
+}
+
+void headless::registerSource(obs_source_t* source)
+{
+	std::lock_guard<std::recursive_mutex> lock(graphMutex());
+	registry.push_back(source);
+}
+
+std::vector<obs_source_t*> headless::registeredSources()
+{
+	std::lock_guard<std::recursive_mutex> lock(graphMutex());
+	return registry;
+}
+
+void headless::clearSources()
+{
+	std::lock_guard<std::recursive_mutex> lock(graphMutex());
+	if (!registry.empty()) {
+		blog(LOG_WARNING, "headless: %d sources still referenced at shutdown",
+			(int)registry.size());
+	}
+	registry.clear();
+}
+
+static void destroySource(obs_source_t* source)
+{
+	if (source->registered) {
+		registry.erase(std::remove(registry.begin(), registry.end(), source), registry.end());
+	}
+
+	if (source->scene) {
+		std::vector<obs_sceneitem_t*> items;
+		items.swap(source->scene->items);
+		for (obs_sceneitem_t* item : items) {
+			item->parent = nullptr;
+			obs_sceneitem_release(item);
+		}
+		delete source->scene;
+	}
+
+	for (obs_source_t* filter : source->filters) {
+		obs_source_release(filter);
+	}
+
+	obs_data_release(source->settings);
+	obs_data_release(source->privateSettings);
+	delete source;
+}
+
+// --- obs_source ---
+
+obs_source_t* obs_source_create(const char* id, const char* name, obs_data_t* settings,
+	obs_data_t* hotkey_data)
+{
+	UNUSED_PARAMETER(hotkey_data);
+
+	const SourceTypeInfo* info = findSourceType(id);
+	if (!info) {
+		blog(LOG_ERROR, "Source ID '%s' not found", id ? id : "");
+		return nullptr;
+	}
+	return headless::createSource(id, name, info->type, settings, true);
+}
+
+obs_source_t* obs_source_create_private(const char* id, const char* name, obs_data_t* settings)
+{
+	const SourceTypeInfo* info = findSourceType(id);
+	if (!info) {
+		blog(LOG_ERROR, "Source ID '%s' not found", id ? id : "");
+		return nullptr;
+	}
+	return headless::createSource(id, name, info->type, settings, false);
+}
+
+void obs_source_addref(obs_source_t* source)
+{
+	if (source) {
+		++source->refs;
+	}
+}
+
+void obs_source_release(obs_source_t* source)
+{
+	if (!source) {
+		return;
+	}
+
+	// Decrement under the graph lock so that registry lookups never revive
+	// a source which is being destroyed
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	if (--source->refs == 0) {
+		destroySource(source);
+	}
+}
+
+obs_source_t* obs_get_source_by_name(const char* name)
+{
+	if (!name) {
+		return nullptr;
+	}
+
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	for (obs_source_t* source : registry) {
+		if (source->name == name) {
+			obs_source_addref(source);
+			return source;
+		}
+	}
+	return nullptr;
+}
+
+obs_source_t* obs_get_output_source(uint32_t channel)
+{
+	// Channel 0 carries the program transition; audio channels are empty
+	if (channel != 0) {
+		return nullptr;
+	}
+	return obs_frontend_get_current_transition();
+}
+
+void obs_enum_sources(bool (*enum_proc)(void*, obs_source_t*), void* param)
+{
+	std::vector<obs_source_t*> inputs;
+	{
+		std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+		for (obs_source_t* source : registry) {
+			if (source->type == OBS_SOURCE_TYPE_INPUT) {
+				obs_source_addref(source);
+				inputs.push_back(source);
+			}
+		}
+	}
+
+	bool proceed = true;
+	for (obs_source_t* source : inputs) {
+		if (proceed) {
+			proceed = enum_proc(param, source);
+		}
+		obs_source_release(source);
+	}
+}
+
+bool obs_enum_source_types(size_t idx, const char** id)
+{
+	if (idx >= sizeof(sourceTypes) / sizeof(sourceTypes[0])) {
+		return false;
+	}
+	*id = sourceTypes[idx].id;
+	return true;
+}
+
+bool obs_enum_input_types(size_t idx, const char** id)
+{
+	return enumSourceTypes(OBS_SOURCE_TYPE_INPUT, idx, id);
+}
+
+bool obs_enum_filter_types(size_t idx, const char** id)
+{
+	return enumSourceTypes(OBS_SOURCE_TYPE_FILTER, idx, id);
+}
+
+bool obs_enum_transition_types(size_t idx, const char** id)
+{
+	return enumSourceTypes(OBS_SOURCE_TYPE_TRANSITION, idx, id);
+}
+
+obs_data_t* obs_get_source_defaults(const char* id)
+{
+	if (!findSourceType(id)) {
+		return nullptr;
+	}
+
+	obs_data_t* defaults = obs_data_create();
+	if (strcmp(id, "color_source") == 0) {
+		obs_data_set_int(defaults, "color", 0xFFFFFFFF);
+		obs_data_set_int(defaults, "width", CANVAS_WIDTH);
+		obs_data_set_int(defaults, "height", CANVAS_HEIGHT);
+	}
+	return defaults;
+}
+
+uint32_t obs_get_source_output_flags(const char* id)
+{
+	const SourceTypeInfo* info = findSourceType(id);
+	return info ? info->outputFlags : 0;
+}
+
+const char* obs_source_get_display_name(const char* id)
+{
+	const SourceTypeInfo* info = findSourceType(id);
+	return info ? info->displayName : nullptr;
+}
+
+const char* obs_source_get_name(const obs_source_t* source)
+{
+	return source ? source->name.c_str() : nullptr;
+}
+
+const char* obs_source_get_id(const obs_source_t* source)
+{
+	return source ? source->id.c_str() : nullptr;
+}
+
+enum obs_source_type obs_source_get_type(const obs_source_t* source)
+{
+	return source ? source->type : OBS_SOURCE_TYPE_INPUT;
+}
+
+obs_data_t* obs_source_get_settings(const obs_source_t* source)
+{
+	if (!source) {
+		return nullptr;
+	}
+
+	obs_data_addref(source->settings);
+	return source->settings;
+}
+
+obs_data_t* obs_source_get_private_settings(obs_source_t* source)
+{
+	if (!source) {
+		return nullptr;
+	}
+
+	obs_data_addref(source->privateSettings);
+	return source->privateSettings;
+}
+
+void obs_source_update(obs_source_t* source, obs_data_t* settings)
+{
+	if (!source || !settings) {
+		return;
+	}
+
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	obs_data_apply(source->settings, settings);
+}
+
+void obs_source_update_properties(obs_source_t* source)
+{
+	UNUSED_PARAMETER(source);
+}
+
+signal_handler_t* obs_source_get_signal_handler(const obs_source_t* source)
+{
+	UNUSED_PARAMETER(source);
+	return nullptr;
+}
+
+float obs_source_get_volume(const obs_source_t* source)
+{
+	return source ? source->volume : 0.0f;
+}
+
+void obs_source_set_volume(obs_source_t* source, float volume)
+{
+	if (source) {
+		source->volume = volume;
+	}
+}
+
+bool obs_source_muted(const obs_source_t* source)
+{
+	return source ? source->muted : false;
+}
+
+void obs_source_set_muted(obs_source_t* source, bool muted)
+{
+	if (source) {
+		source->muted = muted;
+	}
+}
+
+int64_t obs_source_get_sync_offset(const obs_source_t* source)
+{
+	return source ? source->syncOffset : 0;
+}
+
+void obs_source_set_sync_offset(obs_source_t* source, int64_t offset)
+{
+	if (source) {
+		source->syncOffset = offset;
+	}
+}
+
+uint32_t obs_source_get_width(obs_source_t* source)
+{
+	return source ? source->width : 0;
+}
+
+uint32_t obs_source_get_height(obs_source_t* source)
+{
+	return source ? source->height : 0;
+}
+
+uint32_t obs_source_get_base_width(obs_source_t* source)
+{
+	return obs_source_get_width(source);
+}
+
+uint32_t obs_source_get_base_height(obs_source_t* source)
+{
+	return obs_source_get_height(source);
+}
+
+void obs_source_inc_showing(obs_source_t* source)
+{
+	UNUSED_PARAMETER(source);
+}
+
+void obs_source_dec_showing(obs_source_t* source)
+{
+	UNUSED_PARAMETER(source);
+}
+
+void obs_source_video_render(obs_source_t* source)
+{
+	UNUSED_PARAMETER(source);
+}
+
+// --- Filters ---
+
+void obs_source_enum_filters(obs_source_t* source, obs_source_enum_proc_t callback, void* param)
+{
+	if (!source || !callback) {
+		return;
+	}
+
+	std::vector<obs_source_t*> filters;
+	{
+		std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+		filters = source->filters;
+		for (obs_source_t* filter : filters) {
+			obs_source_addref(filter);
+		}
+	}
+
+	for (obs_source_t* filter : filters) {
+		callback(source, filter, param);
+		obs_source_release(filter);
+	}
+}
+
+obs_source_t* obs_source_get_filter_by_name(obs_source_t* source, const char* name)
+{
+	if (!source || !name) {
+		return nullptr;
+	}
+
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	for (obs_source_t* filter : source->filters) {
+		if (filter->name == name) {
+			obs_source_addref(filter);
+			return filter;
+		}
+	}
+	return nullptr;
+}
+
+void obs_source_filter_add(obs_source_t* source, obs_source_t* filter)
+{
+	if (!source || !filter) {
+		return;
+	}
+
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	if (std::find(source->filters.begin(), source->filters.end(), filter) != source->filters.end()) {
+		return;
+	}
+
+	obs_source_addref(filter);
+	source->filters.push_back(filter);
+}
+
+void obs_source_filter_remove(obs_source_t* source, obs_source_t* filter)
+{
+	if (!source || !filter) {
+		return;
+	}
+
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	auto it = std::find(source->filters.begin(), source->filters.end(), filter);
+	if (it != source->filters.end()) {
+		source->filters.erase(it);
+		obs_source_release(filter);
+	}
+}
+
+template<typename T>
+static bool moveEntry(std::vector<T*>& list, T* entry, enum obs_order_movement movement)
+{
+	auto it = std::find(list.begin(), list.end(), entry);
+	if (it == list.end()) {
+		return false;
+	}
+
+	size_t idx = it - list.begin();
+	list.erase(it);
+
+	switch (movement) {
+		case OBS_ORDER_MOVE_UP:
+			idx = std::min(idx + 1, list.size());
+			break;
+		case OBS_ORDER_MOVE_DOWN:
+			idx = (idx > 0 ? idx - 1 : 0);
+			break;
+		case OBS_ORDER_MOVE_TOP:
+			idx = list.size();
+			break;
+		case OBS_ORDER_MOVE_BOTTOM:
+			idx = 0;
+			break;
+	}
+
+	list.insert(list.begin() + idx, entry);
+	return true;
+}
+
+void obs_source_filter_set_order(obs_source_t* source, obs_source_t* filter,
+	enum obs_order_movement movement)
+{
+	if (!source || !filter) {
+		return;
+	}
+
+	// Filters are listed in render order, so "up" moves towards the front
+	switch (movement) {
+		case OBS_ORDER_MOVE_UP: movement = OBS_ORDER_MOVE_DOWN; break;
+		case OBS_ORDER_MOVE_DOWN: movement = OBS_ORDER_MOVE_UP; break;
+		case OBS_ORDER_MOVE_TOP: movement = OBS_ORDER_MOVE_BOTTOM; break;
+		case OBS_ORDER_MOVE_BOTTOM: movement = OBS_ORDER_MOVE_TOP; break;
+	}
+
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	moveEntry(source->filters, filter, movement);
+}
+
+// --- Transitions ---
+
+obs_source_t* obs_transition_get_source(obs_source_t* transition, enum obs_transition_target target)
+{
+	// Transitions complete instantly: A is the program scene, B is empty
+	if (!transition || target != OBS_TRANSITION_SOURCE_A) {
+		return nullptr;
+	}
+	return obs_frontend_get_current_scene();
+}
+
+obs_source_t* obs_transition_get_active_source(obs_source_t* transition)
+{
+	return obs_transition_get_source(transition, OBS_TRANSITION_SOURCE_A);
+}
+
+bool obs_transition_fixed(obs_source_t* transition)
+{
+	return transition && transition->id == "cut_transition";
+}
+
+// --- obs_scene ---
+
+obs_scene_t* obs_scene_from_source(const obs_source_t* source)
+{
+	return source ? source->scene : nullptr;
+}
+
+obs_source_t* obs_scene_get_source(const obs_scene_t* scene)
+{
+	return scene ? scene->source : nullptr;
+}
+
+void obs_scene_addref(obs_scene_t* scene)
+{
+	if (scene) {
+		obs_source_addref(scene->source);
+	}
+}
+
+void obs_scene_release(obs_scene_t* scene)
+{
+	if (scene) {
+		obs_source_release(scene->source);
+	}
+}
+
+obs_sceneitem_t* obs_scene_add(obs_scene_t* scene, obs_source_t* source)
+{
+	if (!scene || !source || source->scene == scene) {
+		return nullptr;
+	}
+
+	obs_sceneitem_t* item = new obs_sceneitem_t();
+	item->refs = 1;
+	item->source = source;
+	item->pos = { 0.0f, 0.0f };
+	item->scale = { 1.0f, 1.0f };
+	item->bounds = { 0.0f, 0.0f };
+	item->rot = 0.0f;
+	item->alignment = OBS_ALIGN_LEFT | OBS_ALIGN_TOP;
+	item->boundsAlignment = OBS_ALIGN_CENTER;
+	item->boundsType = OBS_BOUNDS_NONE;
+	item->crop = { 0, 0, 0, 0 };
+	item->visible = true;
+	item->locked = false;
+	obs_source_addref(source);
+
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	item->parent = scene;
+	item->id = scene->nextItemId++;
+	scene->items.push_back(item);
+	return item;
+}
+
+obs_sceneitem_t* obs_scene_find_source(obs_scene_t* scene, const char* name)
+{
+	if (!scene || !name) {
+		return nullptr;
+	}
+
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	for (obs_sceneitem_t* item : scene->items) {
+		if (item->source->name == name) {
+			return item;
+		}
+	}
+	return nullptr;
+}
+
+void obs_scene_enum_items(obs_scene_t* scene,
+	bool (*callback)(obs_scene_t*, obs_sceneitem_t*, void*), void* param)
+{
+	if (!scene || !callback) {
+		return;
+	}
+
+	std::vector<obs_sceneitem_t*> items;
+	{
+		std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+		items = scene->items;
+		for (obs_sceneitem_t* item : items) {
+			obs_sceneitem_addref(item);
+		}
+	}
+
+	bool proceed = true;
+	for (obs_sceneitem_t* item : items) {
+		if (proceed) {
+			proceed = callback(scene, item, param);
+		}
+		obs_sceneitem_release(item);
+	}
+}
+
+void obs_scene_atomic_update(obs_scene_t* scene, obs_scene_atomic_update_func func, void* data)
+{
+	if (!scene || !func) {
+		return;
+	}
+
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	func(data, scene);
+}
+
+bool obs_scene_reorder_items2(obs_scene_t* scene, struct obs_sceneitem_order_info* item_order,
+	size_t item_order_size)
+{
+	if (!scene || !item_order) {
+		return false;
+	}
+
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	std::vector<obs_sceneitem_t*> ordered;
+	for (size_t i = 0; i < item_order_size; i++) {
+		obs_sceneitem_t* item = item_order[i].item;
+		if (!item || item->parent != scene
+			|| std::find(ordered.begin(), ordered.end(), item) != ordered.end())
+		{
+			return false;
+		}
+		ordered.push_back(item);
+	}
+
+	// Items left out of the new order keep their relative position on top
+	for (obs_sceneitem_t* item : scene->items) {
+		if (std::find(ordered.begin(), ordered.end(), item) == ordered.end()) {
+			ordered.push_back(item);
+		}
+	}
+
+	scene->items.swap(ordered);
+	return true;
+}
+
+// --- obs_sceneitem ---
+
+void obs_sceneitem_addref(obs_sceneitem_t* item)
+{
+	if (item) {
+		++item->refs;
+	}
+}
+
+void obs_sceneitem_release(obs_sceneitem_t* item)
+{
+	if (item && --item->refs == 0) {
+		obs_source_release(item->source);
+		delete item;
+	}
+}
+
+void obs_sceneitem_remove(obs_sceneitem_t* item)
+{
+	if (!item) {
+		return;
+	}
+
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	obs_scene_t* scene = item->parent;
+	if (!scene) {
+		return;
+	}
+
+	scene->items.erase(std::remove(scene->items.begin(), scene->items.end(), item),
+		scene->items.end());
+	item->parent = nullptr;
+	obs_sceneitem_release(item);
+}
+
+obs_scene_t* obs_sceneitem_get_scene(const obs_sceneitem_t* item)
+{
+	return item ? item->parent : nullptr;
+}
+
+obs_source_t* obs_sceneitem_get_source(const obs_sceneitem_t* item)
+{
+	return item ? item->source : nullptr;
+}
+
+int64_t obs_sceneitem_get_id(const obs_sceneitem_t* item)
+{
+	return item ? item->id : 0;
+}
+
+bool obs_sceneitem_is_group(obs_sceneitem_t* item)
+{
+	UNUSED_PARAMETER(item);
+	return false;
+}
+
+void obs_sceneitem_group_enum_items(obs_sceneitem_t* group,
+	bool (*callback)(obs_scene_t*, obs_sceneitem_t*, void*), void* param)
+{
+	UNUSED_PARAMETER(group);
+	UNUSED_PARAMETER(callback);
+	UNUSED_PARAMETER(param);
+}
+
+void obs_sceneitem_set_order(obs_sceneitem_t* item, enum obs_order_movement movement)
+{
+	if (!item) {
+		return;
+	}
+
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	if (item->parent) {
+		moveEntry(item->parent->items, item, movement);
+	}
+}
+
+void obs_sceneitem_set_order_position(obs_sceneitem_t* item, int position)
+{
+	if (!item) {
+		return;
+	}
+
+	std::lock_guard<std::recursive_mutex> lock(headless::graphMutex());
+	obs_scene_t* scene = item->parent;
+	if (!scene) {
+		return;
+	}
+
+	std::vector<obs_sceneitem_t*>& items = scene->items;
+	items.erase(std::remove(items.begin(), items.end(), item), items.end());
+	size_t idx = std::min((size_t)std::max(position, 0), items.size());
+	items.insert(items.begin() + idx, item);
+}
+
+void obs_sceneitem_defer_update_begin(obs_sceneitem_t* item)
+{
+	UNUSED_PARAMETER(item);
+}
+
+void obs_sceneitem_defer_update_end(obs_sceneitem_t* item)
+{
+	UNUSED_PARAMETER(item);
+}
+
+void obs_sceneitem_set_pos(obs_sceneitem_t* item, const struct vec2* pos)
+{
+	if (item && pos) {
+		item->pos = *pos;
+	}
+}
+
+void obs_sceneitem_get_pos(const obs_sceneitem_t* item, struct vec2* pos)
+{
+	if (item && pos) {
+		*pos = item->pos;
+	}
+}
+
+void obs_sceneitem_set_rot(obs_sceneitem_t* item, float rot_deg)
+{
+	if (item) {
+		item->rot = rot_deg;
+	}
+}
+
+float obs_sceneitem_get_rot(const obs_sceneitem_t* item)
+{
+	return item ? item->rot : 0.0f;
+}
+
+void obs_sceneitem_set_scale(obs_sceneitem_t* item, const struct vec2* scale)
+{
+	if (item && scale) {
+		item->scale = *scale;
+	}
+}
+
+void obs_sceneitem_get_scale(const obs_sceneitem_t* item, struct vec2* scale)
+{
+	if (item && scale) {
+		*scale = item->scale;
+	}
+}
+
+void obs_sceneitem_set_alignment(obs_sceneitem_t* item, uint32_t alignment)
+{
+	if (item) {
+		item->alignment = alignment;
+	}
+}
+
+uint32_t obs_sceneitem_get_alignment(const obs_sceneitem_t* item)
+{
+	return item ? item->alignment : 0;
+}
+
+void obs_sceneitem_set_bounds_type(obs_sceneitem_t* item, enum obs_bounds_type type)
+{
+	if (item) {
+		item->boundsType = type;
+	}
+}
+
+enum obs_bounds_type obs_sceneitem_get_bounds_type(const obs_sceneitem_t* item)
+{
+	return item ? item->boundsType : OBS_BOUNDS_NONE;
+}
+
+void obs_sceneitem_set_bounds_alignment(obs_sceneitem_t* item, uint32_t alignment)
+{
+	if (item) {
+		item->boundsAlignment = alignment;
+	}
+}
+
+uint32_t obs_sceneitem_get_bounds_alignment(const obs_sceneitem_t* item)
+{
+	return item ? item->boundsAlignment : 0;
+}
+
+void obs_sceneitem_set_bounds(obs_sceneitem_t* item, const struct vec2* bounds)
+{
+	if (item && bounds) {
+		item->bounds = *bounds;
+	}
+}
+
+void obs_sceneitem_get_bounds(const obs_sceneitem_t* item, struct vec2* bounds)
+{
+	if (item && bounds) {
+		*bounds = item->bounds;
+	}
+}
+
+void obs_sceneitem_set_crop(obs_sceneitem_t* item, const struct obs_sceneitem_crop* crop)
+{
+	if (item && crop) {
+		item->crop = *crop;
+	}
+}
+
+void obs_sceneitem_get_crop(const obs_sceneitem_t* item, struct obs_sceneitem_crop* crop)
+{
+	if (item && crop) {
+		*crop = item->crop;
+	}
+}
+
+bool obs_sceneitem_set_visible(obs_sceneitem_t* item, bool visible)
+{
+	if (!item) {
+		return false;
+	}
+
+	item->visible = visible;
+	return true;
+}
+
+bool obs_sceneitem_visible(const obs_sceneitem_t* item)
+{
+	return item ? item->visible : false;
+}
+
+bool obs_sceneitem_set_locked(obs_sceneitem_t* item, bool locked)
+{
+	if (!item) {
+		return false;
+	}
+
+	item->locked = locked;
+	return true;
+}
+
+bool obs_sceneitem_locked(const obs_sceneitem_t* item)
+{
+	return item ? item->locked : false;
+}
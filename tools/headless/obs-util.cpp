@@ -0,0 +1,426 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include <sys/resource.h>
+#include <sys/statvfs.h>
+#include <unistd.h>
+
+#include <util/base.h>
+#include <util/bmem.h>
+#include <util/config-file.h>
+#include <util/platform.h>
+#include <callback/calldata.h>
+#include <callback/proc.h>
+#include <callback/signal.h>
+
+#include "headless-obs.h"
+#include "headless-internal.h"
+
+// libobs utility layer: logging, allocations, platform queries and the
+// in-memory config store. Signals and procedures are inert, since nothing
+// in the stand-in emits them.
+
+struct os_cpu_usage_info {
+	uint64_t lastTime;
+	uint64_t lastCpuTime;
+	long coreCount;
+};
+
+namespace {
+	std::atomic<int> logLevel(LOG_INFO);
+	std::atomic<long> numAllocs(0);
+
+	// Sentinel handle returned by os_dlopen()
+	int frontendModule;
+
+	uint64_t processCpuTime()
+	{
+		struct rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		return (uint64_t)usage.ru_utime.tv_sec * 1000000000ULL
+			+ (uint64_t)usage.ru_utime.tv_usec * 1000ULL
+			+ (uint64_t)usage.ru_stime.tv_sec * 1000000000ULL
+			+ (uint64_t)usage.ru_stime.tv_usec * 1000ULL;
+	}
+
+	const char* configValue(config_t* config, const char* section, const char* name)
+	{
+		if (!config || !section || !name) {
+			return nullptr;
+		}
+
+		std::lock_guard<std::mutex> lock(config->mutex);
+		for (auto* values : { &config->values, &config->defaults }) {
+			auto sectionIt = values->find(section);
+			if (sectionIt == values->end()) {
+				continue;
+			}
+
+			auto it = sectionIt->second.find(name);
+			if (it != sectionIt->second.end()) {
+				return it->second.c_str();
+			}
+		}
+		return nullptr;
+	}
+
+	void setConfigValue(std::map<std::string, std::map<std::string, std::string>>& values,
+		std::mutex& mutex, const char* section, const char* name, const char* value)
+	{
+		if (!section || !name || !value) {
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		values[section][name] = value;
+	}
+}
+
+void headless_obs_set_log_level(int level)
+{
+	logLevel = level;
+}
+
+// --- Logging ---
+
+void blogva(int log_level, const char* format, va_list args)
+{
+	if (log_level > logLevel) {
+		return;
+	}
+
+	const char* prefix = "";
+	switch (log_level) {
+		case LOG_ERROR: prefix = "error: "; break;
+		case LOG_WARNING: prefix = "warning: "; break;
+		case LOG_DEBUG: prefix = "debug: "; break;
+		default: break;
+	}
+
+	char message[4096];
+	vsnprintf(message, sizeof(message), format, args);
+	fprintf(stderr, "%s%s\n", prefix, message);
+}
+
+void blog(int log_level, const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	blogva(log_level, format, args);
+	va_end(args);
+}
+
+// --- Memory ---
+
+void* bmalloc(size_t size)
+{
+	void* ptr = malloc(size ? size : 1);
+	if (!ptr) {
+		abort();
+	}
+
+	++numAllocs;
+	return ptr;
+}
+
+void* brealloc(void* ptr, size_t size)
+{
+	if (!ptr) {
+		++numAllocs;
+	}
+
+	ptr = realloc(ptr, size ? size : 1);
+	if (!ptr) {
+		abort();
+	}
+	return ptr;
+}
+
+void bfree(void* ptr)
+{
+	if (ptr) {
+		--numAllocs;
+		free(ptr);
+	}
+}
+
+long bnum_allocs(void)
+{
+	return numAllocs;
+}
+
+void* bmemdup(const void* ptr, size_t size)
+{
+	void* out = bmalloc(size);
+	if (size) {
+		memcpy(out, ptr, size);
+	}
+	return out;
+}
+
+// --- Platform ---
+
+uint64_t os_gettime_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void* os_dlopen(const char* path)
+{
+	if (path && strcmp(path, "obs-frontend-api") == 0) {
+		return &frontendModule;
+	}
+	return nullptr;
+}
+
+void* os_dlsym(void* module, const char* func)
+{
+	if (module != &frontendModule || !func) {
+		return nullptr;
+	}
+
+	if (strcmp(func, "obs_frontend_recording_paused") == 0) {
+		return (void*)&headless::recordingPaused;
+	}
+	if (strcmp(func, "obs_frontend_recording_pause") == 0) {
+		return (void*)&headless::pauseRecording;
+	}
+	return nullptr;
+}
+
+void os_dlclose(void* module)
+{
+	UNUSED_PARAMETER(module);
+}
+
+os_cpu_usage_info_t* os_cpu_usage_info_start(void)
+{
+	os_cpu_usage_info_t* info = (os_cpu_usage_info_t*)bmalloc(sizeof(os_cpu_usage_info_t));
+	info->lastTime = os_gettime_ns();
+	info->lastCpuTime = processCpuTime();
+	info->coreCount = sysconf(_SC_NPROCESSORS_ONLN);
+	if (info->coreCount < 1) {
+		info->coreCount = 1;
+	}
+	return info;
+}
+
+double os_cpu_usage_info_query(os_cpu_usage_info_t* info)
+{
+	if (!info) {
+		return 0.0;
+	}
+
+	uint64_t now = os_gettime_ns();
+	uint64_t cpuTime = processCpuTime();
+	if (now <= info->lastTime) {
+		return 0.0;
+	}
+
+	double percent = (double)(cpuTime - info->lastCpuTime)
+		/ (double)(now - info->lastTime) / (double)info->coreCount * 100.0;
+	info->lastTime = now;
+	info->lastCpuTime = cpuTime;
+	return percent;
+}
+
+void os_cpu_usage_info_destroy(os_cpu_usage_info_t* info)
+{
+	bfree(info);
+}
+
+uint64_t os_get_proc_resident_size(void)
+{
+	FILE* statm = fopen("/proc/self/statm", "r");
+	if (!statm) {
+		return 0;
+	}
+
+	unsigned long long totalPages = 0, residentPages = 0;
+	int fields = fscanf(statm, "%llu %llu", &totalPages, &residentPages);
+	fclose(statm);
+	if (fields != 2) {
+		return 0;
+	}
+	return residentPages * (uint64_t)sysconf(_SC_PAGESIZE);
+}
+
+uint64_t os_get_free_disk_space(const char* dir)
+{
+	struct statvfs info;
+	if (!dir || statvfs(dir, &info) != 0) {
+		return 0;
+	}
+	return (uint64_t)info.f_bavail * info.f_frsize;
+}
+
+// --- Config ---
+
+const char* config_get_string(config_t* config, const char* section, const char* name)
+{
+	return configValue(config, section, name);
+}
+
+bool config_get_bool(config_t* config, const char* section, const char* name)
+{
+	const char* value = configValue(config, section, name);
+	if (!value) {
+		return false;
+	}
+	return strcmp(value, "true") == 0 || strtoll(value, nullptr, 10) != 0;
+}
+
+uint64_t config_get_uint(config_t* config, const char* section, const char* name)
+{
+	const char* value = configValue(config, section, name);
+	return value ? strtoull(value, nullptr, 10) : 0;
+}
+
+bool config_has_user_value(config_t const* config, const char* section, const char* name)
+{
+	if (!config || !section || !name) {
+		return false;
+	}
+
+	config_t* mutableConfig = const_cast<config_t*>(config);
+	std::lock_guard<std::mutex> lock(mutableConfig->mutex);
+	auto sectionIt = mutableConfig->values.find(section);
+	return sectionIt != mutableConfig->values.end()
+		&& sectionIt->second.find(name) != sectionIt->second.end();
+}
+
+bool config_remove_value(config_t* config, const char* section, const char* name)
+{
+	if (!config || !section || !name) {
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(config->mutex);
+	auto sectionIt = config->values.find(section);
+	return sectionIt != config->values.end() && sectionIt->second.erase(name) > 0;
+}
+
+int config_save(config_t* config)
+{
+	return config ? CONFIG_SUCCESS : CONFIG_ERROR;
+}
+
+void config_set_string(config_t* config, const char* section, const char* name,
+	const char* value)
+{
+	if (config) {
+		setConfigValue(config->values, config->mutex, section, name, value);
+	}
+}
+
+void config_set_bool(config_t* config, const char* section, const char* name, bool value)
+{
+	config_set_string(config, section, name, value ? "true" : "false");
+}
+
+void config_set_uint(config_t* config, const char* section, const char* name, uint64_t value)
+{
+	config_set_string(config, section, name, std::to_string(value).c_str());
+}
+
+void config_set_default_string(config_t* config, const char* section, const char* name,
+	const char* value)
+{
+	if (config) {
+		setConfigValue(config->defaults, config->mutex, section, name, value);
+	}
+}
+
+void config_set_default_bool(config_t* config, const char* section, const char* name,
+	bool value)
+{
+	config_set_default_string(config, section, name, value ? "true" : "false");
+}
+
+void config_set_default_uint(config_t* config, const char* section, const char* name,
+	uint64_t value)
+{
+	config_set_default_string(config, section, name, std::to_string(value).c_str());
+}
+
+// --- Callbacks ---
+
+bool calldata_get_data(const calldata_t* data, const char* name, void* out, size_t size)
+{
+	UNUSED_PARAMETER(data);
+	UNUSED_PARAMETER(name);
+	UNUSED_PARAMETER(out);
+	UNUSED_PARAMETER(size);
+	return false;
+}
+
+void calldata_set_data(calldata_t* data, const char* name, const void* in, size_t new_size)
+{
+	UNUSED_PARAMETER(data);
+	UNUSED_PARAMETER(name);
+	UNUSED_PARAMETER(in);
+	UNUSED_PARAMETER(new_size);
+}
+
+bool calldata_get_string(const calldata_t* data, const char* name, const char** str)
+{
+	UNUSED_PARAMETER(data);
+	UNUSED_PARAMETER(name);
+	UNUSED_PARAMETER(str);
+	return false;
+}
+
+void signal_handler_connect(signal_handler_t* handler, const char* signal,
+	signal_callback_t callback, void* data)
+{
+	UNUSED_PARAMETER(handler);
+	UNUSED_PARAMETER(signal);
+	UNUSED_PARAMETER(callback);
+	UNUSED_PARAMETER(data);
+}
+
+void signal_handler_disconnect(signal_handler_t* handler, const char* signal,
+	signal_callback_t callback, void* data)
+{
+	UNUSED_PARAMETER(handler);
+	UNUSED_PARAMETER(signal);
+	UNUSED_PARAMETER(callback);
+	UNUSED_PARAMETER(data);
+}
+
+signal_handler_t* obs_get_signal_handler(void)
+{
+	return nullptr;
+}
+
+bool proc_handler_call(proc_handler_t* handler, const char* name, calldata_t* params)
+{
+	UNUSED_PARAMETER(handler);
+	UNUSED_PARAMETER(name);
+	UNUSED_PARAMETER(params);
+	return false;
+}
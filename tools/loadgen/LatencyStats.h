@@ -0,0 +1,74 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <QtCore/QJsonObject>
+
+// Collects latency samples (all in the same unit) and summarizes them as percentiles
+class LatencyStats
+{
+public:
+	void add(double sample) {
+		_samples.push_back(sample);
+	}
+
+	void merge(const LatencyStats& other) {
+		_samples.insert(_samples.end(), other._samples.begin(), other._samples.end());
+	}
+
+	size_t count() const {
+		return _samples.size();
+	}
+
+	QJsonObject summarize() {
+		QJsonObject summary;
+		summary["count"] = (double)_samples.size();
+		if (_samples.empty()) {
+			return summary;
+		}
+
+		std::sort(_samples.begin(), _samples.end());
+
+		double total = 0.0;
+		for (double sample : _samples) {
+			total += sample;
+		}
+
+		summary["mean"] = total / _samples.size();
+		summary["min"] = _samples.front();
+		summary["p50"] = percentile(0.50);
+		summary["p99"] = percentile(0.99);
+		summary["p999"] = percentile(0.999);
+		summary["max"] = _samples.back();
+		return summary;
+	}
+
+private:
+	// Nearest-rank percentile; samples must be sorted
+	double percentile(double p) const {
+		size_t rank = (size_t)std::ceil(p * _samples.size());
+		rank = std::min(std::max<size_t>(rank, 1), _samples.size());
+		return _samples[rank - 1];
+	}
+
+	std::vector<double> _samples;
+};
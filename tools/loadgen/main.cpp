@@ -0,0 +1,716 @@
+/*
+obs-websocket
+Copyright (C) 2016-2019	Stéphane Lepin <stephane.lepin@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+// obs-websocket-loadgen: opens N websocket clients against a running
+// obs-websocket server, sends a weighted mix of requests with a configurable
+// number of requests in flight per client, and reports request latency and
+// event fan-out delay percentiles as JSON. With --local-socket, clients
+// connect to the server's local socket instead, for comparing both transports
+// with the same load.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+
+#include <websocketpp/config/asio_no_tls_client.hpp>
+#include <websocketpp/client.hpp>
+
+#include "LatencyStats.h"
+
+typedef websocketpp::client<websocketpp::config::asio_client> client;
+typedef std::chrono::steady_clock steady_clock;
+
+using websocketpp::connection_hdl;
+using websocketpp::lib::placeholders::_1;
+using websocketpp::lib::placeholders::_2;
+using websocketpp::lib::bind;
+
+#define FANOUT_REALM "obs-websocket-loadgen"
+#define RATE_LIMIT_ERROR "rate limit exceeded"
+
+// Messages on the local socket are NUL-terminated JSON documents
+#define LOCAL_MESSAGE_DELIMITER '\0'
+#define LOCAL_READ_CHUNK_SIZE 16384
+
+// Local sockets are Unix domain sockets, so the local socket mode isn't
+// available on Windows (where the server uses a named pipe)
+#ifdef ASIO_HAS_LOCAL_SOCKETS
+typedef asio::local::stream_protocol local_protocol;
+#endif
+
+struct RequestTemplate {
+	QString requestType;
+	QJsonObject params;
+	int weight;
+};
+
+struct Options {
+	std::string url;
+	std::string localSocket;
+	int clients;
+	int ioThreads;
+	int duration;
+	int pipeline;
+	int fanoutInterval;
+	QString password;
+	std::vector<RequestTemplate> mix;
+};
+
+struct PendingRequest {
+	QString requestType;
+	steady_clock::time_point sentAt;
+};
+
+// Per-client state. Only touched from the handlers of the client's
+// connection, which websocketpp runs one at a time.
+struct ClientState {
+	int index;
+	connection_hdl hdl;
+	std::atomic<bool> ready;
+	std::mt19937 random;
+	uint64_t nextMessageId;
+	std::map<QString, PendingRequest> pending;
+
+	std::map<QString, LatencyStats> latencies;
+	LatencyStats fanoutDelays;
+	uint64_t sent;
+	uint64_t completed;
+	uint64_t errors;
+	uint64_t rejected;
+	uint64_t events;
+	bool failed;
+
+#ifdef ASIO_HAS_LOCAL_SOCKETS
+	// Local socket mode. Handlers run on the strand, one at a time as well.
+	std::unique_ptr<asio::io_service::strand> localStrand;
+	std::unique_ptr<local_protocol::socket> localSocket;
+	char localReadChunk[LOCAL_READ_CHUNK_SIZE];
+	std::string localReadBuffer;
+	std::deque<std::string> localWriteQueue;
+#endif
+};
+
+class LoadGenerator
+{
+public:
+	explicit LoadGenerator(const Options& options);
+	QJsonObject run();
+
+private:
+	void onOpen(ClientState* state);
+	void onFail(ClientState* state, connection_hdl hdl);
+	void onMessage(ClientState* state, connection_hdl hdl, client::message_ptr message);
+	void handleMessage(ClientState* state, const std::string& message);
+
+#ifdef ASIO_HAS_LOCAL_SOCKETS
+	void connectLocal(ClientState* state);
+	void readLocal(ClientState* state);
+	void sendLocal(ClientState* state, std::string message);
+	void writeLocal(ClientState* state);
+	void closeLocal(ClientState* state);
+#endif
+
+	void authenticate(ClientState* state, const QJsonObject& authInfo);
+	void fillPipeline(ClientState* state);
+	void send(ClientState* state, const QJsonObject& request);
+	const RequestTemplate& pickRequest(ClientState* state);
+	void sendFanoutProbe(uint64_t probeId);
+
+	Options _options;
+	client _endpoint;
+	std::vector<std::unique_ptr<ClientState>> _clients;
+	std::atomic<bool> _running;
+	int _totalWeight;
+};
+
+static double elapsedMs(steady_clock::time_point since)
+{
+	return std::chrono::duration<double, std::milli>(steady_clock::now() - since).count();
+}
+
+static QByteArray toJson(const QJsonObject& object)
+{
+	return QJsonDocument(object).toJson(QJsonDocument::Compact);
+}
+
+LoadGenerator::LoadGenerator(const Options& options)
+	: _options(options),
+	  _running(false),
+	  _totalWeight(0)
+{
+	for (auto& request : _options.mix) {
+		_totalWeight += request.weight;
+	}
+
+	_endpoint.clear_access_channels(websocketpp::log::alevel::all);
+	_endpoint.clear_error_channels(websocketpp::log::elevel::all);
+	_endpoint.init_asio();
+}
+
+QJsonObject LoadGenerator::run()
+{
+	for (int i = 0; i < _options.clients; i++) {
+		std::unique_ptr<ClientState> state(new ClientState());
+		state->index = i;
+		state->ready = false;
+		state->random.seed(i);
+		state->nextMessageId = 0;
+		state->sent = state->completed = state->errors = state->rejected = state->events = 0;
+		state->failed = false;
+
+#ifdef ASIO_HAS_LOCAL_SOCKETS
+		if (!_options.localSocket.empty()) {
+			ClientState* statePtr = state.get();
+			_clients.push_back(std::move(state));
+			connectLocal(statePtr);
+			continue;
+		}
+#endif
+
+		websocketpp::lib::error_code errorCode;
+		client::connection_ptr conn = _endpoint.get_connection(_options.url, errorCode);
+		if (errorCode) {
+			fprintf(stderr, "invalid url %s: %s\n", _options.url.c_str(), errorCode.message().c_str());
+			return QJsonObject();
+		}
+
+		ClientState* statePtr = state.get();
+		conn->set_open_handler(bind(&LoadGenerator::onOpen, this, statePtr));
+		conn->set_fail_handler(bind(&LoadGenerator::onFail, this, statePtr, ::_1));
+		conn->set_message_handler(bind(&LoadGenerator::onMessage, this, statePtr, ::_1, ::_2));
+		state->hdl = conn->get_handle();
+
+		_clients.push_back(std::move(state));
+		_endpoint.connect(conn);
+	}
+
+	_running = true;
+	steady_clock::time_point startTime = steady_clock::now();
+
+	std::vector<std::thread> ioThreads;
+	for (int i = 0; i < _options.ioThreads; i++) {
+		ioThreads.emplace_back([this]() {
+			_endpoint.run();
+		});
+	}
+
+	// Periodic BroadcastCustomMessage carrying its send time: every client
+	// receiving the resulting event measures the fan-out delay
+	uint64_t probeId = 0;
+	steady_clock::time_point endTime = startTime + std::chrono::seconds(_options.duration);
+	while (steady_clock::now() < endTime) {
+		if (_options.fanoutInterval > 0) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(_options.fanoutInterval));
+			sendFanoutProbe(probeId++);
+		} else {
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		}
+	}
+
+	_running = false;
+	double runTime = elapsedMs(startTime) / 1000.0;
+
+	// Let requests in flight complete, then disconnect
+	std::this_thread::sleep_for(std::chrono::seconds(1));
+	for (auto& state : _clients) {
+#ifdef ASIO_HAS_LOCAL_SOCKETS
+		if (state->localSocket) {
+			closeLocal(state.get());
+			continue;
+		}
+#endif
+		websocketpp::lib::error_code errorCode;
+		_endpoint.close(state->hdl, websocketpp::close::status::going_away, "", errorCode);
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+	_endpoint.stop();
+	for (auto& thread : ioThreads) {
+		thread.join();
+	}
+
+	// Aggregate
+	std::map<QString, LatencyStats> latencies;
+	LatencyStats allLatencies;
+	LatencyStats fanoutDelays;
+	uint64_t sent = 0, completed = 0, errors = 0, rejected = 0, events = 0;
+	int connected = 0;
+	for (auto& state : _clients) {
+		for (auto& entry : state->latencies) {
+			latencies[entry.first].merge(entry.second);
+			allLatencies.merge(entry.second);
+		}
+		fanoutDelays.merge(state->fanoutDelays);
+		sent += state->sent;
+		completed += state->completed;
+		errors += state->errors;
+		rejected += state->rejected;
+		events += state->events;
+		if (!state->failed) {
+			connected++;
+		}
+	}
+
+	QJsonObject config;
+	if (_options.localSocket.empty()) {
+		config["transport"] = "websocket";
+		config["url"] = QString::fromStdString(_options.url);
+	} else {
+		config["transport"] = "local-socket";
+		config["local-socket"] = QString::fromStdString(_options.localSocket);
+	}
+	config["clients"] = _options.clients;
+	config["io-threads"] = _options.ioThreads;
+	config["duration"] = _options.duration;
+	config["pipeline"] = _options.pipeline;
+	config["fanout-interval"] = _options.fanoutInterval;
+	config["authenticated"] = !_options.password.isEmpty();
+	QJsonArray mix;
+	for (auto& request : _options.mix) {
+		QJsonObject entry;
+		entry["request-type"] = request.requestType;
+		entry["weight"] = request.weight;
+		mix.append(entry);
+	}
+	config["mix"] = mix;
+
+	QJsonObject requests;
+	requests["sent"] = (double)sent;
+	requests["completed"] = (double)completed;
+	requests["errors"] = (double)errors;
+	requests["rejected"] = (double)rejected;
+	requests["throughput"] = completed / runTime;
+
+	QJsonObject latencyByType;
+	for (auto& entry : latencies) {
+		latencyByType[entry.first] = entry.second.summarize();
+	}
+
+	QJsonObject results;
+	results["config"] = config;
+	results["connected-clients"] = connected;
+	results["requests"] = requests;
+	results["latency-ms"] = allLatencies.summarize();
+	results["latency-by-type-ms"] = latencyByType;
+	results["events-received"] = (double)events;
+	results["fanout-delay-ms"] = fanoutDelays.summarize();
+	return results;
+}
+
+void LoadGenerator::onOpen(ClientState* state)
+{
+	if (_options.password.isEmpty()) {
+		state->ready = true;
+		fillPipeline(state);
+		return;
+	}
+
+	QJsonObject request;
+	request["request-type"] = "GetAuthRequired";
+	request["message-id"] = "auth";
+	send(state, request);
+}
+
+void LoadGenerator::onFail(ClientState* state, connection_hdl hdl)
+{
+	client::connection_ptr conn = _endpoint.get_con_from_hdl(hdl);
+	fprintf(stderr, "client %d: connection failed: %s\n",
+		state->index, conn->get_ec().message().c_str());
+	state->failed = true;
+}
+
+void LoadGenerator::onMessage(ClientState* state, connection_hdl hdl, client::message_ptr message)
+{
+	handleMessage(state, message->get_payload());
+}
+
+void LoadGenerator::handleMessage(ClientState* state, const std::string& message)
+{
+	steady_clock::time_point receivedAt = steady_clock::now();
+
+	QJsonObject payload = QJsonDocument::fromJson(QByteArray::fromStdString(message)).object();
+
+	if (payload.contains("update-type")) {
+		state->events++;
+
+		if (payload["update-type"].toString() == "BroadcastCustomMessage"
+			&& payload["realm"].toString() == FANOUT_REALM)
+		{
+			steady_clock::duration sentAt((steady_clock::rep)
+				payload["data"].toObject()["sent"].toString().toLongLong());
+			state->fanoutDelays.add(std::chrono::duration<double, std::milli>(
+				receivedAt.time_since_epoch() - sentAt).count());
+		}
+		return;
+	}
+
+	QString messageId = payload["message-id"].toString();
+	bool ok = (payload["status"].toString() == "ok");
+
+	if (messageId == "auth") {
+		if (!ok) {
+			fprintf(stderr, "client %d: GetAuthRequired failed\n", state->index);
+			return;
+		}
+		if (payload["authRequired"].toBool()) {
+			authenticate(state, payload);
+		} else {
+			state->ready = true;
+			fillPipeline(state);
+		}
+		return;
+	}
+
+	if (messageId == "authenticate") {
+		if (!ok) {
+			fprintf(stderr, "client %d: authentication failed: %s\n",
+				state->index, payload["error"].toString().toUtf8().constData());
+			return;
+		}
+		state->ready = true;
+		fillPipeline(state);
+		return;
+	}
+
+	auto it = state->pending.find(messageId);
+	if (it == state->pending.end()) {
+		// Fan-out probe response
+		return;
+	}
+
+	state->latencies[it->second.requestType].add(
+		std::chrono::duration<double, std::milli>(receivedAt - it->second.sentAt).count());
+	state->pending.erase(it);
+
+	state->completed++;
+	if (!ok) {
+		state->errors++;
+		if (payload["error"].toString() == RATE_LIMIT_ERROR) {
+			state->rejected++;
+		}
+	}
+
+	fillPipeline(state);
+}
+
+void LoadGenerator::authenticate(ClientState* state, const QJsonObject& authInfo)
+{
+	QByteArray secret = QCryptographicHash::hash(
+		_options.password.toUtf8() + authInfo["salt"].toString().toUtf8(),
+		QCryptographicHash::Sha256).toBase64();
+	QByteArray authResponse = QCryptographicHash::hash(
+		secret + authInfo["challenge"].toString().toUtf8(),
+		QCryptographicHash::Sha256).toBase64();
+
+	QJsonObject request;
+	request["request-type"] = "Authenticate";
+	request["message-id"] = "authenticate";
+	request["auth"] = QString::fromUtf8(authResponse);
+	send(state, request);
+}
+
+void LoadGenerator::fillPipeline(ClientState* state)
+{
+	while (_running && state->pending.size() < (size_t)_options.pipeline) {
+		const RequestTemplate& requestTemplate = pickRequest(state);
+
+		QString messageId = QString::number(state->nextMessageId++);
+		QJsonObject request = requestTemplate.params;
+		request["request-type"] = requestTemplate.requestType;
+		request["message-id"] = messageId;
+
+		PendingRequest& pending = state->pending[messageId];
+		pending.requestType = requestTemplate.requestType;
+		pending.sentAt = steady_clock::now();
+
+		send(state, request);
+		state->sent++;
+	}
+}
+
+void LoadGenerator::send(ClientState* state, const QJsonObject& request)
+{
+#ifdef ASIO_HAS_LOCAL_SOCKETS
+	if (state->localSocket) {
+		sendLocal(state, toJson(request).toStdString());
+		return;
+	}
+#endif
+
+	websocketpp::lib::error_code errorCode;
+	_endpoint.send(state->hdl, toJson(request).toStdString(),
+		websocketpp::frame::opcode::text, errorCode);
+	if (errorCode) {
+		fprintf(stderr, "client %d: send failed: %s\n",
+			state->index, errorCode.message().c_str());
+	}
+}
+
+const RequestTemplate& LoadGenerator::pickRequest(ClientState* state)
+{
+	std::uniform_int_distribution<int> distribution(0, _totalWeight - 1);
+	int pick = distribution(state->random);
+	for (auto& request : _options.mix) {
+		pick -= request.weight;
+		if (pick < 0) {
+			return request;
+		}
+	}
+	return _options.mix.back();
+}
+
+// Sent through the first ready client. Its response is not tracked, so this
+// doesn't touch the client's state and is safe from the main thread.
+void LoadGenerator::sendFanoutProbe(uint64_t probeId)
+{
+	for (auto& state : _clients) {
+		if (!state->ready) {
+			continue;
+		}
+
+		QJsonObject data;
+		data["sent"] = QString::number(
+			(qlonglong)steady_clock::now().time_since_epoch().count());
+
+		QJsonObject request;
+		request["request-type"] = "BroadcastCustomMessage";
+		request["message-id"] = QString("fanout-%1").arg(probeId);
+		request["realm"] = FANOUT_REALM;
+		request["data"] = data;
+		send(state.get(), request);
+		return;
+	}
+}
+
+#ifdef ASIO_HAS_LOCAL_SOCKETS
+// Local clients run on the websocket endpoint's io_service, so that both
+// transports are served by the same io threads
+void LoadGenerator::connectLocal(ClientState* state)
+{
+	asio::io_service& ioService = _endpoint.get_io_service();
+	state->localStrand.reset(new asio::io_service::strand(ioService));
+	state->localSocket.reset(new local_protocol::socket(ioService));
+
+	state->localSocket->async_connect(local_protocol::endpoint(_options.localSocket),
+		state->localStrand->wrap([this, state](const asio::error_code& errorCode) {
+			if (errorCode) {
+				fprintf(stderr, "client %d: connection failed: %s\n",
+					state->index, errorCode.message().c_str());
+				state->failed = true;
+				return;
+			}
+
+			readLocal(state);
+			onOpen(state);
+		}));
+}
+
+void LoadGenerator::readLocal(ClientState* state)
+{
+	state->localSocket->async_read_some(asio::buffer(state->localReadChunk),
+		state->localStrand->wrap([this, state](const asio::error_code& errorCode, size_t length) {
+			if (errorCode) {
+				// Closed, by closeLocal() or by the server
+				return;
+			}
+
+			state->localReadBuffer.append(state->localReadChunk, length);
+
+			size_t start = 0;
+			size_t delimiterPos;
+			while ((delimiterPos = state->localReadBuffer.find(LOCAL_MESSAGE_DELIMITER, start))
+				!= std::string::npos)
+			{
+				handleMessage(state, state->localReadBuffer.substr(start, delimiterPos - start));
+				start = delimiterPos + 1;
+			}
+			state->localReadBuffer.erase(0, start);
+
+			readLocal(state);
+		}));
+}
+
+// Writes are queued on the strand, since the fan-out probe is sent from the
+// main thread and asio sockets don't support concurrent writes
+void LoadGenerator::sendLocal(ClientState* state, std::string message)
+{
+	message.push_back(LOCAL_MESSAGE_DELIMITER);
+	state->localStrand->post([this, state, message]() {
+		state->localWriteQueue.push_back(message);
+		if (state->localWriteQueue.size() == 1) {
+			writeLocal(state);
+		}
+	});
+}
+
+void LoadGenerator::writeLocal(ClientState* state)
+{
+	asio::async_write(*state->localSocket, asio::buffer(state->localWriteQueue.front()),
+		state->localStrand->wrap([this, state](const asio::error_code& errorCode, size_t) {
+			if (errorCode) {
+				fprintf(stderr, "client %d: send failed: %s\n",
+					state->index, errorCode.message().c_str());
+				state->localWriteQueue.clear();
+				return;
+			}
+
+			state->localWriteQueue.pop_front();
+			if (!state->localWriteQueue.empty()) {
+				writeLocal(state);
+			}
+		}));
+}
+
+void LoadGenerator::closeLocal(ClientState* state)
+{
+	state->localStrand->post([state]() {
+		asio::error_code errorCode;
+		state->localSocket->shutdown(local_protocol::socket::shutdown_both, errorCode);
+		state->localSocket->close(errorCode);
+	});
+}
+#endif
+
+static bool parseMix(const QString& spec, std::vector<RequestTemplate>& mix)
+{
+	for (const QString& entry : spec.split(',', QString::SkipEmptyParts)) {
+		QStringList parts = entry.split(':');
+		RequestTemplate request;
+		request.requestType = parts[0].trimmed();
+		request.weight = (parts.size() > 1) ? parts[1].toInt() : 1;
+		if (request.requestType.isEmpty() || request.weight <= 0) {
+			return false;
+		}
+		mix.push_back(request);
+	}
+	return !mix.empty();
+}
+
+// Mix file: JSON array of { "request-type", "weight", "params" } objects
+static bool loadMixFile(const QString& path, std::vector<RequestTemplate>& mix)
+{
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly)) {
+		return false;
+	}
+
+	QJsonArray entries = QJsonDocument::fromJson(file.readAll()).array();
+	for (const QJsonValue& value : entries) {
+		QJsonObject entry = value.toObject();
+		RequestTemplate request;
+		request.requestType = entry["request-type"].toString();
+		request.weight = entry["weight"].toInt(1);
+		request.params = entry["params"].toObject();
+		if (request.requestType.isEmpty() || request.weight <= 0) {
+			return false;
+		}
+		mix.push_back(request);
+	}
+	return !mix.empty();
+}
+
+int main(int argc, char* argv[])
+{
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setApplicationName("obs-websocket-loadgen");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Load generator and latency benchmark for obs-websocket");
+	parser.addHelpOption();
+
+	QCommandLineOption urlOption("url", "Server URL.", "url", "ws://127.0.0.1:4444");
+	QCommandLineOption localSocketOption("local-socket",
+		"Connect to the server's local socket (LocalSocketPath setting) instead of its URL.", "path");
+	QCommandLineOption clientsOption("clients", "Number of clients.", "count", "10");
+	QCommandLineOption threadsOption("threads", "Number of io threads.", "count", "1");
+	QCommandLineOption durationOption("duration", "Test duration in seconds.", "seconds", "10");
+	QCommandLineOption pipelineOption("pipeline", "Requests in flight per client.", "count", "1");
+	QCommandLineOption fanoutOption("fanout-interval",
+		"Interval between fan-out probes (BroadcastCustomMessage), 0 to disable.", "ms", "100");
+	QCommandLineOption passwordOption("password", "Authenticate with this password.", "password");
+	QCommandLineOption mixOption("mix", "Request mix, as RequestType:weight pairs separated by commas.",
+		"mix", "GetVersion:1,GetCurrentScene:1,GetSceneList:1");
+	QCommandLineOption mixFileOption("mix-file",
+		"JSON file with the request mix, including request parameters.", "path");
+	QCommandLineOption outputOption("output", "Write results to this file instead of stdout.", "path");
+
+	parser.addOptions({ urlOption, localSocketOption, clientsOption, threadsOption, durationOption, pipelineOption,
+		fanoutOption, passwordOption, mixOption, mixFileOption, outputOption });
+	parser.process(app);
+
+	Options options;
+	options.url = parser.value(urlOption).toStdString();
+	options.localSocket = parser.value(localSocketOption).toStdString();
+	options.clients = std::max(1, parser.value(clientsOption).toInt());
+	options.ioThreads = std::max(1, parser.value(threadsOption).toInt());
+	options.duration = std::max(1, parser.value(durationOption).toInt());
+	options.pipeline = std::max(1, parser.value(pipelineOption).toInt());
+	options.fanoutInterval = std::max(0, parser.value(fanoutOption).toInt());
+	options.password = parser.value(passwordOption);
+
+#ifndef ASIO_HAS_LOCAL_SOCKETS
+	if (!options.localSocket.empty()) {
+		fprintf(stderr, "local socket mode needs Unix domain sockets, unavailable on this platform\n");
+		return 1;
+	}
+#endif
+
+	bool mixLoaded = parser.isSet(mixFileOption)
+		? loadMixFile(parser.value(mixFileOption), options.mix)
+		: parseMix(parser.value(mixOption), options.mix);
+	if (!mixLoaded) {
+		fprintf(stderr, "invalid request mix\n");
+		return 1;
+	}
+
+	LoadGenerator generator(options);
+	QJsonObject results = generator.run();
+	if (results.isEmpty()) {
+		return 1;
+	}
+
+	QByteArray output = QJsonDocument(results).toJson(QJsonDocument::Indented);
+	if (parser.isSet(outputOption)) {
+		QFile file(parser.value(outputOption));
+		if (!file.open(QIODevice::WriteOnly)) {
+			fprintf(stderr, "can't write %s\n", parser.value(outputOption).toUtf8().constData());
+			return 1;
+		}
+		file.write(output);
+	} else {
+		fwrite(output.constData(), 1, output.size(), stdout);
+	}
+
+	return 0;
+}